@@ -1,12 +1,32 @@
 /* 
  * Compression application using adaptive arithmetic coding
  * 
- * Usage: AdaptiveArithmeticCompress InputFile OutputFile
+ * Usage: AdaptiveArithmeticCompress [--stats] [--binary] [--symbol-bits=8|16] [--length-prefix] [--flush-every=N] [--blocks [--block-size=N] [--threads=N] [--auto-model]] InputFile OutputFile
+ * Either file name can be "-" to read from standard input or write to standard output.
  * Then use the corresponding "AdaptiveArithmeticDecompress" application to recreate the original input file.
  * Note that the application starts with a flat frequency table of 257 symbols (all set to a frequency of 1),
  * and updates it after each byte encoded. The corresponding decompressor program also starts with a flat
  * frequency table and updates it after each byte decoded. It is by design that the compressor and
  * decompressor have synchronized states, so that the data can be decompressed properly.
+ * With --binary, each byte is instead coded as 8 binary decisions down a tree of 255 adaptive bit
+ * probabilities (see BitTreeModel.hpp), preceded by an adaptive decision that says whether the data
+ * has ended. Each update takes constant time and the decoder needs no division, so this is faster,
+ * and the probabilities favor recent statistics. The same option must be given to the decompressor.
+ * With --symbol-bits=16, the input is coded as little-endian 16-bit symbols (see WideSymbolIo.hpp)
+ * with an adaptive table of 65537 symbols, whose Fenwick tree keeps each update logarithmic, or with
+ * --binary as 16 binary decisions per symbol. This doesn't work with --blocks, whose models code bytes.
+ * The same --symbol-bits must be given to the decompressor.
+ * With --length-prefix, the output starts with the input length (see LengthHeader.hpp), and the bytes
+ * are coded with a table of 256 symbols (or the bit tree alone) and no EOF symbol or end decisions.
+ * This needs a seekable input and 8-bit symbols, and the same option must be given to the decompressor.
+ * With --flush-every=N, the coder is flushed to a byte boundary after every N bytes while the model
+ * carries on (see ArithmeticEncoder::flush()), so a prefix of the output that ends at a flush point
+ * decodes to all the bytes before it. The same option must be given to the decompressor.
+ * With --blocks, the input is split into blocks of N bytes (default 1 MiB) that are compressed
+ * independently on N worker threads, and the output is a block container (see BlockContainer.hpp).
+ * With --auto-model, each block is coded with whichever model (stored, static of order 0 or 1, adaptive
+ * binary, adaptive, or PPM of order 1 to 3) is estimated to suit it best instead of this application's model.
+ * With --stats, counts of coding events are printed to standard error (see CodingStats.hpp).
  * 
  * Copyright (c) Project Nayuki
  * 
@@ -14,35 +34,130 @@
  * https://github.com/nayuki/Reference-arithmetic-coding
  */
 
+#include <cstddef>
 #include <cstdint>
 #include <cstdlib>
-#include <fstream>
 #include <iostream>
 #include <stdexcept>
+#include <string>
+#include <vector>
 #include "ArithmeticCoder.hpp"
 #include "BitIoStream.hpp"
+#include "BitTreeModel.hpp"
+#include "BlockContainer.hpp"
+#include "CodingStats.hpp"
+#include "CommandLine.hpp"
+#include "FileStream.hpp"
 #include "FrequencyTable.hpp"
+#include "LengthHeader.hpp"
+#include "ThreadPool.hpp"
+#include "WideSymbolIo.hpp"
 
 using std::uint32_t;
 
 
+static void compressWide(std::istream &in, BitOutputStream &out, bool binary);
+
+static void compressWithLength(std::istream &in, BitOutputStream &out, bool binary);
+
+
 int main(int argc, char *argv[]) {
 	// Handle command line arguments
-	if (argc != 3) {
-		std::cerr << "Usage: " << argv[0] << " InputFile OutputFile" << std::endl;
+	CommandLine cmd(argc, argv);
+	const std::vector<std::string> &args = cmd.getArguments();
+	bool validArgs = args.size() == 2 && cmd.hasOnlyOptions({"stats", "binary", "symbol-bits", "length-prefix", "flush-every", "blocks", "block-size", "threads", "auto-model"});
+	unsigned long symbolBits = 8;
+	unsigned long flushInterval = 0;
+	try {
+		symbolBits = cmd.getNumber("symbol-bits", 8);
+		flushInterval = cmd.getNumber("flush-every", 0);
+	} catch (const std::exception &e) {
+		std::cerr << e.what() << std::endl;
+		validArgs = false;
+	}
+	if (!validArgs) {
+		std::cerr << "Usage: " << argv[0] << " [--stats] [--binary] [--symbol-bits=8|16] [--length-prefix] [--flush-every=N] [--blocks [--block-size=N] [--threads=N] [--auto-model]] InputFile OutputFile" << std::endl;
+		return EXIT_FAILURE;
+	}
+	const char *inputFile  = args.at(0).c_str();
+	const char *outputFile = args.at(1).c_str();
+	if ((symbolBits != 8 && symbolBits != 16) || (symbolBits == 16 && cmd.hasOption("blocks"))) {
+		std::cerr << "Symbol bits must be 8 or 16, and 16 is not supported with --blocks" << std::endl;
+		return EXIT_FAILURE;
+	}
+	bool lengthPrefix = cmd.hasOption("length-prefix");
+	if (lengthPrefix && (symbolBits != 8 || cmd.hasOption("blocks"))) {
+		std::cerr << "--length-prefix is only supported with 8-bit symbols and without --blocks" << std::endl;
+		return EXIT_FAILURE;
+	}
+	if (flushInterval != 0 && (symbolBits != 8 || lengthPrefix || cmd.hasOption("blocks"))) {
+		std::cerr << "--flush-every is only supported with 8-bit symbols and without --length-prefix or --blocks" << std::endl;
 		return EXIT_FAILURE;
 	}
-	const char *inputFile  = argv[1];
-	const char *outputFile = argv[2];
 	
 	// Perform file compression
-	std::ifstream in(inputFile, std::ios::binary);
-	std::ofstream out(outputFile, std::ios::binary);
-	BitOutputStream bout(out);
 	try {
+		InputFileStream in(inputFile);
+		OutputFileStream out(outputFile);
+		if (cmd.hasOption("blocks")) {
+			// Compress independent blocks on multiple threads into a block container
+			std::size_t blockSize = cmd.getNumber("block-size", BlockCompressor::DEFAULT_BLOCK_SIZE);
+			unsigned int threads = static_cast<unsigned int>(cmd.getNumber("threads", ThreadPool::defaultThreadCount()));
+			BlockCompressor comp = cmd.hasOption("auto-model") ? BlockCompressor(blockSize, threads)
+				: BlockCompressor(cmd.hasOption("binary") ? BlockModel::ADAPTIVE_BINARY : BlockModel::ADAPTIVE, 0, blockSize, threads);
+			comp.compress(in, out);
+			out.finish();
+			if (cmd.hasOption("stats"))
+				CodingStats::dump(std::cerr);
+			return EXIT_SUCCESS;
+		}
+		
+		BitOutputStream bout(out);
+		if (symbolBits == 16 || lengthPrefix) {
+			if (symbolBits == 16)
+				compressWide(in, bout, cmd.hasOption("binary"));
+			else
+				compressWithLength(in, bout, cmd.hasOption("binary"));
+			bout.finish();
+			out.finish();
+			if (cmd.hasOption("stats"))
+				CodingStats::dump(std::cerr);
+			return EXIT_SUCCESS;
+		}
+		
+		if (cmd.hasOption("binary")) {
+			BitTreeModel endModel(1);
+			BitTreeModel byteModel(8);
+			ArithmeticEncoder enc(32, bout);
+			unsigned long numSinceFlush = 0;
+			while (true) {
+				// Read one byte, and encode that the data continues and then the byte
+				int symbol = in.get();
+				if (symbol == EOF)
+					break;
+				if (symbol < 0 || symbol > 255)
+					throw std::logic_error("Assertion error");
+				endModel.encodeSymbol(enc, 0);
+				byteModel.encodeSymbol(enc, static_cast<uint32_t>(symbol));
+				if (flushInterval != 0 && ++numSinceFlush == flushInterval) {
+					enc.flush();
+					out.flush();
+					numSinceFlush = 0;
+				}
+			}
+			
+			endModel.encodeSymbol(enc, 1);  // EOF
+			enc.finish();  // Flush remaining code bits
+			bout.finish();
+			out.finish();
+			if (cmd.hasOption("stats"))
+				CodingStats::dump(std::cerr);
+			return EXIT_SUCCESS;
+		}
 		
 		SimpleFrequencyTable freqs(FlatFrequencyTable(257));
 		ArithmeticEncoder enc(32, bout);
+		unsigned long numSinceFlush = 0;
 		while (true) {
 			// Read and encode one byte
 			int symbol = in.get();
@@ -52,15 +167,86 @@ int main(int argc, char *argv[]) {
 				throw std::logic_error("Assertion error");
 			enc.write(freqs, static_cast<uint32_t>(symbol));
 			freqs.increment(static_cast<uint32_t>(symbol));
+			if (flushInterval != 0 && ++numSinceFlush == flushInterval) {
+				// Make everything so far decodable without ending the stream
+				enc.flush();
+				out.flush();
+				numSinceFlush = 0;
+			}
 		}
 		
 		enc.write(freqs, 256);  // EOF
 		enc.finish();  // Flush remaining code bits
 		bout.finish();
+		out.finish();
+		if (cmd.hasOption("stats"))
+			CodingStats::dump(std::cerr);
 		return EXIT_SUCCESS;
 		
 	} catch (const char *msg) {
 		std::cerr << msg << std::endl;
 		return EXIT_FAILURE;
+	} catch (const std::exception &e) {
+		std::cerr << e.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+}
+
+
+// Compresses 16-bit symbols with the same kind of model as for bytes. The EOF symbol is NUM_SYMBOLS, or
+// a 1 from the end model in binary mode, and is followed by the trailing byte of an odd-length input.
+static void compressWide(std::istream &in, BitOutputStream &out, bool binary) {
+	FenwickFrequencyTable freqs(FlatFrequencyTable(WideSymbolIo::NUM_SYMBOLS + 1));
+	BitTreeModel endModel(1);
+	BitTreeModel symbolModel(16);
+	ArithmeticEncoder enc(32, out);
+	int trailingByte;
+	while (true) {
+		// Read and encode one symbol
+		long symbol = WideSymbolIo::readSymbol(in, trailingByte);
+		if (symbol == -1)
+			break;
+		uint32_t sym = static_cast<uint32_t>(symbol);
+		if (binary) {
+			endModel.encodeSymbol(enc, 0);
+			symbolModel.encodeSymbol(enc, sym);
+		} else {
+			enc.write(freqs, sym);
+			freqs.increment(sym);
+		}
+	}
+	
+	if (binary)
+		endModel.encodeSymbol(enc, 1);  // EOF
+	else
+		enc.write(freqs, WideSymbolIo::NUM_SYMBOLS);  // EOF
+	WideSymbolIo::encodeTrailer(enc, trailingByte);
+	enc.finish();  // Flush remaining code bits
+}
+
+
+// Writes the length of the rest of the input, then codes exactly that many bytes with the
+// same kind of model as for the EOF-terminated format, but over 256 symbols and with no end.
+static void compressWithLength(std::istream &in, BitOutputStream &out, bool binary) {
+	std::uint64_t length = LengthHeader::getRemainingLength(in);
+	LengthHeader::write(length, out);
+	SimpleFrequencyTable freqs(FlatFrequencyTable(256));
+	BitTreeModel byteModel(8);
+	ArithmeticEncoder enc(32, out);
+	for (std::uint64_t i = 0; i < length; i++) {
+		// Read and encode one byte
+		int symbol = in.get();
+		if (symbol == EOF)
+			throw std::runtime_error("Input ended before its length");
+		if (symbol < 0 || symbol > 255)
+			throw std::logic_error("Assertion error");
+		uint32_t sym = static_cast<uint32_t>(symbol);
+		if (binary)
+			byteModel.encodeSymbol(enc, sym);
+		else {
+			enc.write(freqs, sym);
+			freqs.increment(sym);
+		}
 	}
+	enc.flush();  // End with no bits that the decoder must pad (see LengthHeader.hpp)
 }
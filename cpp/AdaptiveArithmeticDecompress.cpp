@@ -1,8 +1,17 @@
 /* 
  * Decompression application using adaptive arithmetic coding
  * 
- * Usage: AdaptiveArithmeticDecompress InputFile OutputFile
- * This decompresses files generated by the "AdaptiveArithmeticCompress" application.
+ * Usage: AdaptiveArithmeticDecompress [--stats] [--binary] [--symbol-bits=8|16] [--length-prefix] [--flush-every=N] [--blocks [--threads=N] [--offset=N --length=N]] InputFile OutputFile
+ * Either file name can be "-" to read from standard input or write to standard output.
+ * This decompresses files generated by the "AdaptiveArithmeticCompress" application,
+ * which must be given --binary if and only if the compressor was (this doesn't matter with --blocks),
+ * and the same --symbol-bits, --length-prefix, and --flush-every as the compressor.
+ * With --blocks, the input must be a block container produced by the --blocks mode
+ * of any of the compression applications, since each block records its own model.
+ * The blocks are decoded concurrently on N worker threads. With --offset and --length, only that byte
+ * range of the original data is written, and only the blocks overlapping it are decoded; this needs a
+ * seekable input, and the compressor's block size sets the granularity of the random access.
+ * With --stats, counts of coding events are printed to standard error (see CodingStats.hpp).
  * 
  * Copyright (c) Project Nayuki
  * 
@@ -12,33 +21,120 @@
 
 #include <cstdint>
 #include <cstdlib>
-#include <fstream>
 #include <iostream>
 #include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
 #include "ArithmeticCoder.hpp"
 #include "BitIoStream.hpp"
+#include "BitTreeModel.hpp"
+#include "BlockContainer.hpp"
+#include "CodingStats.hpp"
+#include "CommandLine.hpp"
+#include "FileStream.hpp"
 #include "FrequencyTable.hpp"
+#include "LengthHeader.hpp"
+#include "ThreadPool.hpp"
+#include "WideSymbolIo.hpp"
 
 using std::uint32_t;
 
 
+static void decompressWide(BitInputStream &in, std::ostream &out, bool binary);
+
+static void decompressWithLength(BitInputStream &in, std::ostream &out, bool binary);
+
+
 int main(int argc, char *argv[]) {
 	// Handle command line arguments
-	if (argc != 3) {
-		std::cerr << "Usage: " << argv[0] << " InputFile OutputFile" << std::endl;
+	CommandLine cmd(argc, argv);
+	const std::vector<std::string> &args = cmd.getArguments();
+	bool validArgs = args.size() == 2 && cmd.hasOnlyOptions({"stats", "binary", "symbol-bits", "length-prefix", "flush-every", "blocks", "threads", "offset", "length"})
+			&& cmd.hasOption("offset") == cmd.hasOption("length");
+	unsigned long symbolBits = 8;
+	unsigned long flushInterval = 0;
+	try {
+		symbolBits = cmd.getNumber("symbol-bits", 8);
+		flushInterval = cmd.getNumber("flush-every", 0);
+	} catch (const std::exception &e) {
+		std::cerr << e.what() << std::endl;
+		validArgs = false;
+	}
+	if (!validArgs) {
+		std::cerr << "Usage: " << argv[0] << " [--stats] [--binary] [--symbol-bits=8|16] [--length-prefix] [--flush-every=N] [--blocks [--threads=N] [--offset=N --length=N]] InputFile OutputFile" << std::endl;
+		return EXIT_FAILURE;
+	}
+	const char *inputFile  = args.at(0).c_str();
+	const char *outputFile = args.at(1).c_str();
+	if ((symbolBits != 8 && symbolBits != 16) || (symbolBits == 16 && cmd.hasOption("blocks"))) {
+		std::cerr << "Symbol bits must be 8 or 16, and 16 is not supported with --blocks" << std::endl;
+		return EXIT_FAILURE;
+	}
+	bool lengthPrefix = cmd.hasOption("length-prefix");
+	if (lengthPrefix && (symbolBits != 8 || cmd.hasOption("blocks"))) {
+		std::cerr << "--length-prefix is only supported with 8-bit symbols and without --blocks" << std::endl;
+		return EXIT_FAILURE;
+	}
+	if (flushInterval != 0 && (symbolBits != 8 || lengthPrefix || cmd.hasOption("blocks"))) {
+		std::cerr << "--flush-every is only supported with 8-bit symbols and without --length-prefix or --blocks" << std::endl;
 		return EXIT_FAILURE;
 	}
-	const char *inputFile  = argv[1];
-	const char *outputFile = argv[2];
 	
 	// Perform file decompression
-	std::ifstream in(inputFile, std::ios::binary);
-	std::ofstream out(outputFile, std::ios::binary);
-	BitInputStream bin(in);
 	try {
+		InputFileStream in(inputFile);
+		OutputFileStream out(outputFile);
+		if (cmd.hasOption("blocks")) {
+			BlockDecompressor decomp(static_cast<unsigned int>(cmd.getNumber("threads", ThreadPool::defaultThreadCount())));
+			if (cmd.hasOption("offset"))
+				decomp.decompressRange(in, out, cmd.getNumber("offset", 0), cmd.getNumber("length", 0));
+			else
+				decomp.decompress(in, out);
+			out.finish();
+			if (cmd.hasOption("stats"))
+				CodingStats::dump(std::cerr);
+			return EXIT_SUCCESS;
+		}
+		
+		BitInputStream bin(in);
+		if (symbolBits == 16 || lengthPrefix) {
+			if (symbolBits == 16)
+				decompressWide(bin, out, cmd.hasOption("binary"));
+			else
+				decompressWithLength(bin, out, cmd.hasOption("binary"));
+			out.finish();
+			if (cmd.hasOption("stats"))
+				CodingStats::dump(std::cerr);
+			return EXIT_SUCCESS;
+		}
+		
+		if (cmd.hasOption("binary")) {
+			BitTreeModel endModel(1);
+			BitTreeModel byteModel(8);
+			ArithmeticDecoder dec(32, bin);
+			unsigned long numSinceFlush = 0;
+			while (endModel.decodeSymbol(dec) == 0) {
+				// Decode and write one byte
+				int b = static_cast<int>(byteModel.decodeSymbol(dec));
+				if (std::numeric_limits<char>::is_signed)
+					b -= (b >> 7) << 8;
+				out.put(static_cast<char>(b));
+				if (flushInterval != 0 && ++numSinceFlush == flushInterval) {
+					dec.flush();
+					out.flush();
+					numSinceFlush = 0;
+				}
+			}
+			out.finish();
+			if (cmd.hasOption("stats"))
+				CodingStats::dump(std::cerr);
+			return EXIT_SUCCESS;
+		}
 		
 		SimpleFrequencyTable freqs(FlatFrequencyTable(257));
 		ArithmeticDecoder dec(32, bin);
+		unsigned long numSinceFlush = 0;
 		while (true) {
 			// Decode and write one byte
 			uint32_t symbol = dec.read(freqs);
@@ -49,11 +145,72 @@ int main(int argc, char *argv[]) {
 				b -= (b >> 7) << 8;
 			out.put(static_cast<char>(b));
 			freqs.increment(symbol);
+			if (flushInterval != 0 && ++numSinceFlush == flushInterval) {
+				// Consume the compressor's flush bits without reading past them
+				dec.flush();
+				out.flush();
+				numSinceFlush = 0;
+			}
 		}
+		out.finish();
+		if (cmd.hasOption("stats"))
+			CodingStats::dump(std::cerr);
 		return EXIT_SUCCESS;
 		
 	} catch (const char *msg) {
 		std::cerr << msg << std::endl;
 		return EXIT_FAILURE;
+	} catch (const std::exception &e) {
+		std::cerr << e.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+}
+
+
+// Decodes the 16-bit symbols written by compressWide() in AdaptiveArithmeticCompress, then the trailing byte.
+static void decompressWide(BitInputStream &in, std::ostream &out, bool binary) {
+	FenwickFrequencyTable freqs(FlatFrequencyTable(WideSymbolIo::NUM_SYMBOLS + 1));
+	BitTreeModel endModel(1);
+	BitTreeModel symbolModel(16);
+	ArithmeticDecoder dec(32, in);
+	while (true) {
+		// Decode and write one symbol
+		uint32_t symbol;
+		if (binary) {
+			if (endModel.decodeSymbol(dec) == 1)
+				break;
+			symbol = symbolModel.decodeSymbol(dec);
+		} else {
+			symbol = dec.read(freqs);
+			if (symbol == WideSymbolIo::NUM_SYMBOLS)  // EOF symbol
+				break;
+			freqs.increment(symbol);
+		}
+		WideSymbolIo::writeSymbol(out, symbol);
+	}
+	
+	WideSymbolIo::writeTrailer(out, WideSymbolIo::decodeTrailer(dec));
+}
+
+
+// Reads the length written by compressWithLength() in AdaptiveArithmeticCompress, then decodes exactly that many bytes.
+static void decompressWithLength(BitInputStream &in, std::ostream &out, bool binary) {
+	std::uint64_t length = LengthHeader::read(in);
+	SimpleFrequencyTable freqs(FlatFrequencyTable(256));
+	BitTreeModel byteModel(8);
+	ArithmeticDecoder dec(32, in, true);
+	for (std::uint64_t i = 0; i < length; i++) {
+		// Decode and write one byte
+		uint32_t symbol;
+		if (binary)
+			symbol = byteModel.decodeSymbol(dec);
+		else {
+			symbol = dec.read(freqs);
+			freqs.increment(symbol);
+		}
+		int b = static_cast<int>(symbol);
+		if (std::numeric_limits<char>::is_signed)
+			b -= (b >> 7) << 8;
+		out.put(static_cast<char>(b));
 	}
 }
@@ -6,9 +6,11 @@
  * https://github.com/nayuki/Reference-arithmetic-coding
  */
 
+#include <cmath>
 #include <limits>
 #include <stdexcept>
 #include "ArithmeticCoder.hpp"
+#include "CodingStats.hpp"
 
 using std::uint32_t;
 using std::uint64_t;
@@ -24,8 +26,13 @@ ArithmeticCoderBase::ArithmeticCoderBase(int numBits) {
 	minimumRange = quarterRange + 2;  // At least 2
 	maximumTotal = std::min(std::numeric_limits<decltype(fullRange)>::max() / fullRange, minimumRange);
 	stateMask = fullRange - 1;
+	maximumBypassBits = 0;
+	while ((UINT64_C(2) << maximumBypassBits) <= maximumTotal)
+		maximumBypassBits++;
 	low = 0;
 	high = stateMask;
+	shiftTotal = 1;
+	shiftAmount = 0;
 }
 
 
@@ -50,14 +57,61 @@ void ArithmeticCoderBase::update(const FrequencyTable &freqs, uint32_t symbol) {
 		throw std::invalid_argument("Cannot code symbol because total is too large");
 	
 	// Update range
-	uint64_t newLow  = low + symLow  * range / total;
-	uint64_t newHigh = low + symHigh * range / total - 1;
+	uint64_t newLow, newHigh;
+	int totalShift = getTotalShift(total);
+	if (totalShift != -1) {
+		newLow  = low + (symLow  * range >> totalShift);
+		newHigh = low + (symHigh * range >> totalShift) - 1;
+	} else {
+		newLow  = low + symLow  * range / total;
+		newHigh = low + symHigh * range / total - 1;
+	}
+	CODING_STATS_ADD(SYMBOLS_CODED, 1);
+	setRange(newLow, newHigh);
+}
+
+
+void ArithmeticCoderBase::updateBit(uint32_t zeroProbability, int bit) {
+	uint64_t zeroRange = getZeroRange(zeroProbability);
+	CODING_STATS_ADD(SYMBOLS_CODED, 1);
+	if (bit == 0)
+		setRange(low, low + zeroRange - 1);
+	else
+		setRange(low + zeroRange, high);
+}
+
+
+uint64_t ArithmeticCoderBase::getZeroRange(uint32_t zeroProbability) const {
+	if (zeroProbability == 0 || zeroProbability >= (UINT32_C(1) << PROBABILITY_BITS))
+		throw std::domain_error("Probability out of range");
+	if ((UINT64_C(1) << PROBABILITY_BITS) > maximumTotal)
+		throw std::invalid_argument("Cannot code bit because state size is too small");
+	return (high - low + 1) * zeroProbability >> PROBABILITY_BITS;
+}
+
+
+void ArithmeticCoderBase::updateBits(uint32_t value, int numBits) {
+	if (numBits < 0 || numBits > 32 || (numBits < 32 && value >> numBits != 0))
+		throw std::domain_error("Value out of range");
+	CODING_STATS_ADD(SYMBOLS_CODED, 1);
+	for (int remaining = numBits; remaining > 0; ) {
+		int n = std::min(remaining, maximumBypassBits);
+		remaining -= n;
+		uint64_t piece = (value >> remaining) & ((UINT64_C(1) << n) - 1);
+		uint64_t range = high - low + 1;
+		setRange(low + (piece * range >> n), low + ((piece + 1) * range >> n) - 1);
+	}
+}
+
+
+void ArithmeticCoderBase::setRange(uint64_t newLow, uint64_t newHigh) {
 	low = newLow;
 	high = newHigh;
 	
 	// While low and high have the same top bit value, shift them out
 	while (((low ^ high) & halfRange) == 0) {
 		shift();
+		CODING_STATS_ADD(BITS_SHIFTED, 1);
 		low  = ((low  << 1) & stateMask);
 		high = ((high << 1) & stateMask) | 1;
 	}
@@ -66,39 +120,66 @@ void ArithmeticCoderBase::update(const FrequencyTable &freqs, uint32_t symbol) {
 	// While low's top two bits are 01 and high's are 10, delete the second highest bit of both
 	while ((low & ~high & quarterRange) != 0) {
 		underflow();
+		CODING_STATS_ADD(UNDERFLOWS, 1);
 		low = (low << 1) ^ halfRange;
 		high = ((high ^ halfRange) << 1) | halfRange | 1;
 	}
 }
 
 
-ArithmeticDecoder::ArithmeticDecoder(int numBits, BitInputStream &in) :
+void ArithmeticCoderBase::saveRange(CheckpointWriter &out) const {
+	out.write(static_cast<uint64_t>(numStateBits));
+	out.write(low);
+	out.write(high);
+}
+
+
+void ArithmeticCoderBase::loadRange(CheckpointReader &in) {
+	if (in.read(63) != static_cast<uint64_t>(numStateBits))
+		throw std::runtime_error("Different arithmetic coder state size in checkpoint");
+	uint64_t newLow = in.read(stateMask);
+	uint64_t newHigh = in.read(stateMask);
+	if (newLow >= newHigh || ((newLow ^ newHigh) & halfRange) == 0 || (newLow & ~newHigh & quarterRange) != 0
+			|| newHigh - newLow + 1 < minimumRange)
+		throw std::runtime_error("Invalid arithmetic coder state in checkpoint");
+	low = newLow;
+	high = newHigh;
+}
+
+
+int ArithmeticCoderBase::getTotalShift(uint32_t total) {
+	if (total == shiftTotal)
+		return shiftAmount;
+	if (total == 0 || (total & (total - 1)) != 0)
+		return -1;
+	int result = 0;
+	while ((UINT32_C(1) << result) != total)
+		result++;
+	shiftTotal = total;
+	shiftAmount = result;
+	return result;
+}
+
+
+ArithmeticDecoder::ArithmeticDecoder(int numBits, BitInputStream &in, bool flushedEnd) :
 		ArithmeticCoderBase(numBits),
 		input(in),
-		code(0) {
-	for (int i = 0; i < numStateBits; i++)
-		code = code << 1 | readCodeBit();
+		code(0),
+		isCodePending(true),
+		endsWithFlush(flushedEnd) {
+	fillCode();
 }
 
 
 uint32_t ArithmeticDecoder::read(const FrequencyTable &freqs) {
-	// Translate from coding range scale to frequency table scale
-	uint32_t total = freqs.getTotal();
-	if (total > maximumTotal)
-		throw std::invalid_argument("Cannot decode symbol because total is too large");
-	uint64_t range = high - low + 1;
-	uint64_t offset = code - low;
-	uint64_t value = ((offset + 1) * total - 1) / range;
-	if (value * range / total > offset)
-		throw std::logic_error("Assertion error");
-	if (value >= total)
-		throw std::logic_error("Assertion error");
+	uint32_t value = getScaledCode(freqs.getTotal());
 	
 	// A kind of binary search. Find highest symbol such that freqs.getLow(symbol) <= value.
 	uint32_t start = 0;
 	uint32_t end = freqs.getSymbolLimit();
 	while (end - start > 1) {
 		uint32_t middle = (start + end) >> 1;
+		CODING_STATS_ADD(DECODER_SEARCH_STEPS, 1);
 		if (freqs.getLow(middle) > value)
 			end = middle;
 		else
@@ -107,13 +188,137 @@ uint32_t ArithmeticDecoder::read(const FrequencyTable &freqs) {
 	if (start + 1 != end)
 		throw std::logic_error("Assertion error");
 	
-	uint32_t symbol = start;
-	if (offset < freqs.getLow(symbol) * range / total || freqs.getHigh(symbol) * range / total <= offset)
+	consume(freqs, start);
+	return start;
+}
+
+
+uint32_t ArithmeticDecoder::read(const LookupFrequencyTable &freqs) {
+	uint32_t value = getScaledCode(freqs.getTotal());
+	uint32_t symbol = freqs.getSymbol(value);
+	consume(freqs, symbol);
+	return symbol;
+}
+
+
+int ArithmeticDecoder::readBit(uint32_t zeroProbability) {
+	fillCode();
+	int bit = code - low < getZeroRange(zeroProbability) ? 0 : 1;
+	updateBit(zeroProbability, bit);
+	return bit;
+}
+
+
+uint32_t ArithmeticDecoder::readBits(int numBits) {
+	if (numBits < 0 || numBits > 32)
+		throw std::domain_error("Number of bits out of range");
+	fillCode();
+	uint32_t result = 0;
+	for (int remaining = numBits; remaining > 0; ) {
+		int n = std::min(remaining, maximumBypassBits);
+		remaining -= n;
+		// Find the highest piece whose part of the range starts at or below the code
+		uint64_t range = high - low + 1;
+		uint64_t offset = code - low;
+		uint32_t piece = 0;
+		for (int i = n - 1; i >= 0; i--) {
+			uint32_t trial = piece | UINT32_C(1) << i;
+			if ((trial * range >> n) <= offset)
+				piece = trial;
+		}
+		updateBits(piece, n);
+		result = static_cast<uint32_t>(static_cast<uint64_t>(result) << n) | piece;
+	}
+	return result;
+}
+
+
+uint32_t ArithmeticDecoder::read(const FenwickFrequencyTable &freqs) {
+	uint32_t value = getScaledCode(freqs.getTotal());
+	uint32_t symbol = freqs.getSymbol(value);
+	consume(freqs, symbol);
+	return symbol;
+}
+
+
+uint32_t ArithmeticDecoder::read(const SparseFrequencyTable &freqs) {
+	uint32_t value = getScaledCode(freqs.getTotal());
+	uint32_t symbol = freqs.getSymbol(value);
+	consume(freqs, symbol);
+	return symbol;
+}
+
+
+void ArithmeticDecoder::flush() {
+	// The encoder wrote exactly the bits that the code register holds (which are
+	// still pending if no symbol was decoded since the last flush), then padding
+	fillCode();
+	input.alignToByte();
+	low = 0;
+	high = stateMask;
+	code = 0;
+	isCodePending = true;
+}
+
+
+void ArithmeticDecoder::saveState(CheckpointWriter &out) const {
+	saveRange(out);
+	out.write(code);
+	out.write(isCodePending ? 1 : 0);
+	input.saveState(out);
+}
+
+
+void ArithmeticDecoder::loadState(CheckpointReader &in) {
+	loadRange(in);
+	uint64_t newCode = in.read(stateMask);
+	bool pending = in.read(1) == 1;
+	if (pending ? (low != 0 || high != stateMask) : (newCode < low || newCode > high))
+		throw std::runtime_error("Invalid arithmetic coder state in checkpoint");
+	input.loadState(in);
+	code = newCode;
+	isCodePending = pending;
+}
+
+
+void ArithmeticDecoder::fillCode() {
+	if (!isCodePending)
+		return;
+	for (int i = 0; i < numStateBits; i++)
+		code = code << 1 | readCodeBit();
+	isCodePending = false;
+}
+
+
+uint32_t ArithmeticDecoder::getScaledCode(uint32_t total) {
+	fillCode();
+	// Translate from coding range scale to frequency table scale
+	if (total > maximumTotal)
+		throw std::invalid_argument("Cannot decode symbol because total is too large");
+	uint64_t range = high - low + 1;
+	uint64_t offset = code - low;
+	uint64_t value = ((offset + 1) * total - 1) / range;
+	int totalShift = getTotalShift(total);
+	if ((totalShift != -1 ? value * range >> totalShift : value * range / total) > offset)
+		throw std::logic_error("Assertion error");
+	if (value >= total)
+		throw std::logic_error("Assertion error");
+	return static_cast<uint32_t>(value);
+}
+
+
+void ArithmeticDecoder::consume(const FrequencyTable &freqs, uint32_t symbol) {
+	uint32_t total = freqs.getTotal();
+	uint64_t range = high - low + 1;
+	uint64_t offset = code - low;
+	int totalShift = getTotalShift(total);
+	uint64_t symLow  = freqs.getLow (symbol) * range;
+	uint64_t symHigh = freqs.getHigh(symbol) * range;
+	if (totalShift != -1 ? (offset < symLow >> totalShift || symHigh >> totalShift <= offset) : (offset < symLow / total || symHigh / total <= offset))
 		throw std::logic_error("Assertion error");
 	update(freqs, symbol);
 	if (code < low || code > high)
 		throw std::logic_error("Assertion error: Code out of range");
-	return symbol;
 }
 
 
@@ -129,8 +334,11 @@ void ArithmeticDecoder::underflow() {
 
 int ArithmeticDecoder::readCodeBit() {
 	int temp = input.read();
-	if (temp == -1)
+	if (temp == -1) {
+		if (endsWithFlush)
+			throw std::runtime_error("Compressed data ended early");
 		temp = 0;
+	}
 	return temp;
 }
 
@@ -138,11 +346,60 @@ int ArithmeticDecoder::readCodeBit() {
 ArithmeticEncoder::ArithmeticEncoder(int numBits, BitOutputStream &out) :
 	ArithmeticCoderBase(numBits),
 	output(out),
-	numUnderflow(0) {}
+	numUnderflow(0),
+	costMeter(nullptr) {}
 
 
 void ArithmeticEncoder::write(const FrequencyTable &freqs, uint32_t symbol) {
+	if (costMeter == nullptr) {
+		update(freqs, symbol);
+		return;
+	}
+	uint64_t range = high - low + 1;
 	update(freqs, symbol);
+	// Recompute the size of the subrange that update() chose, before it was rescaled
+	uint32_t total = freqs.getTotal();
+	uint64_t newRange = freqs.getHigh(symbol) * range / total - freqs.getLow(symbol) * range / total;
+	costMeter->record(freqs, symbol, range, newRange);
+}
+
+
+void ArithmeticEncoder::writeBit(uint32_t zeroProbability, int bit) {
+	if (bit != 0 && bit != 1)
+		throw std::domain_error("Bit must be 0 or 1");
+	if (costMeter == nullptr) {
+		updateBit(zeroProbability, bit);
+		return;
+	}
+	uint64_t range = high - low + 1;
+	uint64_t zeroRange = getZeroRange(zeroProbability);
+	updateBit(zeroProbability, bit);
+	double one = static_cast<double>(UINT32_C(1) << PROBABILITY_BITS);
+	double probability = (bit == 0 ? zeroProbability : one - zeroProbability) / one;
+	uint64_t newRange = bit == 0 ? zeroRange : range - zeroRange;
+	costMeter->record(-std::log2(probability), std::log2(static_cast<double>(range)) - std::log2(static_cast<double>(newRange)));
+}
+
+
+void ArithmeticEncoder::writeBits(uint32_t value, int numBits) {
+	if (costMeter == nullptr) {
+		updateBits(value, numBits);
+		return;
+	}
+	if (numBits < 0 || numBits > 32 || (numBits < 32 && value >> numBits != 0))
+		throw std::domain_error("Value out of range");
+	// Code the same pieces as updateBits() one at a time, summing the cost of each
+	double codedBits = 0;
+	for (int remaining = numBits; remaining > 0; ) {
+		int n = std::min(remaining, maximumBypassBits);
+		remaining -= n;
+		uint64_t piece = (value >> remaining) & ((UINT64_C(1) << n) - 1);
+		uint64_t range = high - low + 1;
+		uint64_t newRange = ((piece + 1) * range >> n) - (piece * range >> n);
+		updateBits(static_cast<uint32_t>(piece), n);
+		codedBits += std::log2(static_cast<double>(range)) - std::log2(static_cast<double>(newRange));
+	}
+	costMeter->record(numBits, codedBits);
 }
 
 
@@ -151,6 +408,45 @@ void ArithmeticEncoder::finish() {
 }
 
 
+void ArithmeticEncoder::flush() {
+	// Since low < half <= high, the value of a 1 followed by 0s is in the range. Writing it in full, including
+	// the pending underflow bits, makes the output as long as the decoder has read, which is one bit per shift
+	// or underflow plus the numStateBits bits of the code register, so its code register ends here too.
+	output.write(1);
+	for (; numUnderflow > 0; numUnderflow--)
+		output.write(0);
+	for (int i = 1; i < numStateBits; i++)
+		output.write(0);
+	output.finish();
+	low = 0;
+	high = stateMask;
+}
+
+
+void ArithmeticEncoder::saveState(CheckpointWriter &out) const {
+	saveRange(out);
+	out.write(numUnderflow);
+	output.saveState(out);
+}
+
+
+void ArithmeticEncoder::loadState(CheckpointReader &in) {
+	loadRange(in);
+	numUnderflow = static_cast<unsigned long>(in.read(std::numeric_limits<unsigned long>::max()));
+	output.loadState(in);
+}
+
+
+void ArithmeticEncoder::setCostMeter(CodingCostMeter *meter) {
+	costMeter = meter;
+}
+
+
+CodingCostMeter *ArithmeticEncoder::getCostMeter() const {
+	return costMeter;
+}
+
+
 void ArithmeticEncoder::shift() {
 	int bit = static_cast<int>(low >> (numStateBits - 1));
 	output.write(bit);
@@ -165,4 +461,5 @@ void ArithmeticEncoder::underflow() {
 	if (numUnderflow == std::numeric_limits<decltype(numUnderflow)>::max())
 		throw std::overflow_error("Maximum underflow reached");
 	numUnderflow++;
+	CODING_STATS_MAX(MAX_PENDING_UNDERFLOWS, numUnderflow);
 }
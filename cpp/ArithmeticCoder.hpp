@@ -11,6 +11,8 @@
 #include <algorithm>
 #include <cstdint>
 #include "BitIoStream.hpp"
+#include "Checkpoint.hpp"
+#include "CodingCostMeter.hpp"
 #include "FrequencyTable.hpp"
 
 
@@ -19,6 +21,12 @@
  */
 class ArithmeticCoderBase {
 	
+	/*---- Constants ----*/
+	
+	// The probabilities of binary decisions (see updateBit()) are fractions of 2^PROBABILITY_BITS.
+	public: static constexpr int PROBABILITY_BITS = 12;
+	
+	
 	/*---- Configuration fields ----*/
 	
 	// Number of bits for the 'low' and 'high' state variables. Must be in the range [1, 63].
@@ -50,6 +58,9 @@ class ArithmeticCoderBase {
 	// Maximum allowed total from a frequency table at all times during coding.
 	protected: std::uint64_t maximumTotal;
 	
+	// The most equiprobable bits that updateBits() codes in one step, which is floor(log2(maximumTotal)).
+	protected: int maximumBypassBits;
+	
 	// Bit mask of numStateBits ones, which is 0111...111.
 	protected: std::uint64_t stateMask;
 	
@@ -62,6 +73,11 @@ class ArithmeticCoderBase {
 	// High end of this arithmetic coder's current range. Conceptually has an infinite number of trailing 1s.
 	protected: std::uint64_t high;
 	
+	// The most recent frequency table total that was a power of two, and its base-2 logarithm.
+	// A static model codes every symbol with the same total, so this saves recomputing the shift.
+	private: std::uint32_t shiftTotal;
+	private: int shiftAmount;
+	
 	
 	/*---- Constructor ----*/
 	
@@ -90,6 +106,42 @@ class ArithmeticCoderBase {
 	protected: virtual void update(const FrequencyTable &freqs, std::uint32_t symbol);
 	
 	
+	// Updates the code range like update(), for a binary decision where the given bit (0 or 1) is coded and
+	// zeroProbability / 2^PROBABILITY_BITS is the probability of a 0, which must be in the range (0, 1).
+	// Because the total is a power of two, this splits the range with a multiplication and a shift.
+	protected: void updateBit(std::uint32_t zeroProbability, int bit);
+	
+	
+	// Returns the size of the part of the current range that codes a 0 with the given probability.
+	protected: std::uint64_t getZeroRange(std::uint32_t zeroProbability) const;
+	
+	
+	// Updates the code range for the given value of the given number of bits (in the range [0, 32]), where every
+	// value is equally likely. The bits are taken from the most significant down in pieces of at most maximumBypassBits,
+	// and each piece selects one of 2^n equal parts of the range with a multiplication and a shift, so that this
+	// is the same as coding the piece with a frequency table of 2^n symbols of frequency 1 but without the table.
+	protected: void updateBits(std::uint32_t value, int numBits);
+	
+	
+	// Sets the code range to the given values, then shifts out the top bits that low and high share
+	// and removes underflow bits, restoring the invariants described at update().
+	private: void setRange(std::uint64_t newLow, std::uint64_t newHigh);
+	
+	
+	// Appends the state size and the code range to the given checkpoint.
+	protected: void saveRange(CheckpointWriter &out) const;
+	
+	
+	// Restores the code range saved by saveRange(). Throws an exception if the checkpoint
+	// is malformed, is of a different state size, or doesn't satisfy the invariants above.
+	protected: void loadRange(CheckpointReader &in);
+	
+	
+	// Returns log2(total) if the given frequency table total is a power of two, otherwise -1. Dividing
+	// by such a total is done with a right shift by this amount, which gives the same result.
+	protected: int getTotalShift(std::uint32_t total);
+	
+	
 	// Called to handle the situation when the top bit of 'low' and 'high' are equal.
 	protected: virtual void shift() = 0;
 	
@@ -114,12 +166,21 @@ class ArithmeticDecoder final : private ArithmeticCoderBase {
 	// The current raw code bits being buffered, which is always in the range [low, high].
 	private: std::uint64_t code;
 	
+	// Whether the code bits must be filled before the next symbol is decoded, which is the case
+	// after flush(), so that flush() returns without reading any bits past the encoder's flush point.
+	private: bool isCodePending;
+	
+	// Whether the coded data ends with ArithmeticEncoder::flush() instead of finish(), in which case
+	// the decoder never needs bits past the end, and reaching the end means the data was truncated.
+	private: bool endsWithFlush;
+	
 	
 	/*---- Constructor ----*/
 	
-	// Constructs an arithmetic coding decoder based on the
-	// given bit input stream, and fills the code bits.
-	public: explicit ArithmeticDecoder(int numBits, BitInputStream &in);
+	// Constructs an arithmetic coding decoder based on the given bit input stream, and fills the code bits.
+	// If flushedEnd is true, the encoder must have ended the data with flush(), and reading past the end
+	// throws an exception instead of supplying the zeros that the shorter ending of finish() relies on.
+	public: explicit ArithmeticDecoder(int numBits, BitInputStream &in, bool flushedEnd=false);
 	
 	
 	/*---- Methods ----*/
@@ -129,14 +190,72 @@ class ArithmeticDecoder final : private ArithmeticCoderBase {
 	public: std::uint32_t read(const FrequencyTable &freqs);
 	
 	
+	// Decodes the next symbol like read(const FrequencyTable &), but finds it
+	// with a single table lookup instead of a search over the cumulative frequencies.
+	public: std::uint32_t read(const LookupFrequencyTable &freqs);
+	
+	
+	// Decodes the next symbol like read(const FrequencyTable &), but finds it by descending
+	// the table's Fenwick tree, which takes O(log n) time instead of O(log^2 n).
+	public: std::uint32_t read(const FenwickFrequencyTable &freqs);
+	
+	
+	// Decodes the next symbol like read(const FrequencyTable &), but finds it by scanning only the symbols
+	// that the table stores, instead of a binary search over the whole alphabet.
+	public: std::uint32_t read(const SparseFrequencyTable &freqs);
+	
+	
+	// Decodes and returns the next bit (0 or 1) of a binary decision, given the probability of a 0
+	// in units of 2^-PROBABILITY_BITS (see ArithmeticCoderBase::updateBit()). This needs no division.
+	public: int readBit(std::uint32_t zeroProbability);
+	
+	
+	// Decodes and returns an unsigned integer of the given number of bits (in the range [0, 32]), where every
+	// value is equally likely (see ArithmeticCoderBase::updateBits()). This needs no table, and instead of a
+	// division each piece of bits is found by a binary search with one multiplication per bit.
+	public: std::uint32_t readBits(int numBits);
+	
+	
+	// Consumes the bits that ArithmeticEncoder::flush() wrote, including the padding to a byte boundary,
+	// and resets the coder to the state of a new stream. Call this after decoding the symbol that preceded
+	// the encoder's flush(). No bits after that point are read until the next symbol is decoded, so every
+	// symbol before a flush point can be decoded once the bytes up to that point have arrived.
+	public: void flush();
+	
+	
+	// Appends the state of this decoder, including the position in the bit input stream, to the given
+	// checkpoint. Together with the state of the caller's models, this lets decoding resume at the
+	// current symbol without decoding the data before it (see loadState()).
+	public: void saveState(CheckpointWriter &out) const;
+	
+	
+	// Restores the state saved by saveState() into this decoder, whose bit input stream must be over a seekable
+	// stream of the same coded data starting at the same position as the original one (see BitInputStream::
+	// loadState()). The numbers of state bits must match. Throws an exception if the checkpoint is malformed.
+	public: void loadState(CheckpointReader &in);
+	
+	
+	// Fills the code bits from the input if they are pending after flush().
+	private: void fillCode();
+	
+	
+	// Returns the current code scaled to the given frequency table total, which is the
+	// cumulative frequency value that falls in the range of the next symbol.
+	private: std::uint32_t getScaledCode(std::uint32_t total);
+	
+	
+	// Checks that the given symbol is the one the code points to, and updates the state past it.
+	private: void consume(const FrequencyTable &freqs, std::uint32_t symbol);
+	
+	
 	protected: void shift() override;
 	
 	
 	protected: void underflow() override;
 	
 	
-	// Returns the next bit (0 or 1) from the input stream. The end
-	// of stream is treated as an infinite number of trailing zeros.
+	// Returns the next bit (0 or 1) from the input stream. The end of stream is treated as an
+	// infinite number of trailing zeros, unless the data ends with a flush (see endsWithFlush).
 	private: int readCodeBit();
 	
 };
@@ -157,6 +276,9 @@ class ArithmeticEncoder final : private ArithmeticCoderBase {
 	// so a truly correct implementation would use a bigint.
 	private: unsigned long numUnderflow;
 	
+	// Receives the cost of every coded symbol if not null. Not owned by this object.
+	private: CodingCostMeter *costMeter;
+	
 	
 	/*---- Constructor ----*/
 	
@@ -171,12 +293,51 @@ class ArithmeticEncoder final : private ArithmeticCoderBase {
 	public: void write(const FrequencyTable &freqs, std::uint32_t symbol);
 	
 	
+	// Encodes the given bit (0 or 1) of a binary decision, given the probability of a 0 in
+	// units of 2^-PROBABILITY_BITS (see ArithmeticCoderBase::updateBit()).
+	public: void writeBit(std::uint32_t zeroProbability, int bit);
+	
+	
+	// Encodes the given unsigned integer of the given number of bits (in the range [0, 32]), where every
+	// value is equally likely, such as a hash or an identifier. This costs numBits bits with no frequency
+	// table and no division, and usually in one step (see ArithmeticCoderBase::updateBits()).
+	public: void writeBits(std::uint32_t value, int numBits);
+	
+	
 	// Terminates the arithmetic coding by flushing any buffered bits, so that the output can be decoded properly.
 	// It is important that this method must be called at the end of the each encoding process.
 	// Note that this method merely writes data to the underlying output stream but does not close it.
 	public: void finish();
 	
 	
+	// Writes out enough bits that the decoder can decode every symbol written so far, pads the output to a
+	// byte boundary, and resets the coder to the state of a new stream, keeping whatever models the caller
+	// uses. The decoder must call ArithmeticDecoder::flush() at the same point. This lets a receiver process
+	// each message of a stream as soon as it arrives, at a cost of numStateBits bits plus pending underflow
+	// bits plus the padding per flush point. The caller must still flush the underlying output stream.
+	public: void flush();
+	
+	
+	// Appends the state of this encoder, including the partial byte of the bit output stream, to the given
+	// checkpoint. Together with the state of the caller's models, this lets encoding resume later, for
+	// example in another process, producing exactly the output that continuing now would have.
+	public: void saveState(CheckpointWriter &out) const;
+	
+	
+	// Restores the state saved by saveState() into this newly constructed encoder and its unwritten bit output
+	// stream, whose underlying stream must end just after the bytes written at the checkpoint (see BitOutputStream::
+	// loadState()). The numbers of state bits must match. Throws an exception if the checkpoint is malformed.
+	public: void loadState(CheckpointReader &in);
+	
+	
+	// Sets the meter that the cost of each subsequently written symbol is recorded in, or null to stop
+	// recording. The meter must outlive its use by this encoder. Recording makes each write() slower.
+	public: void setCostMeter(CodingCostMeter *meter);
+	
+	
+	public: CodingCostMeter *getCostMeter() const;
+	
+	
 	protected: void shift() override;
 	
 	
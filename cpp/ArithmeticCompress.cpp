@@ -1,11 +1,29 @@
 /* 
  * Compression application using static arithmetic coding
  * 
- * Usage: ArithmeticCompress InputFile OutputFile
+ * Usage: ArithmeticCompress [--stats] [--order=0|1] [--length-prefix] [--threads=N] [--blocks [--block-size=N] [--auto-model]] InputFile OutputFile
+ * The input and output file names can be "-" to use standard input and output. The whole input is
+ * held in memory, where the byte frequencies are counted on N threads before it is coded.
  * Then use the corresponding "ArithmeticDecompress" application to recreate the original input file.
  * Note that the application uses an alphabet of 257 symbols - 256 symbols for the byte
- * values and 1 symbol for the EOF marker. The compressed file format starts with a list
- * of 256 symbol frequencies, and then followed by the arithmetic-coded data.
+ * values and 1 symbol for the EOF marker. The compressed file format starts with a compact
+ * table of 256 symbol frequencies (see FrequencyHeader.hpp), followed by the arithmetic-coded data.
+ * With --order=1, each byte is coded with a table conditioned on the previous byte, which suits data
+ * with strong byte-to-byte structure such as logs. The file then starts with a bit for each of the
+ * 256 possible previous bytes saying whether it has a table, followed by those tables in the same
+ * compact form (normalized to totals of at most 2^12), followed by the coded data. This model is still
+ * static and allocates nothing while coding, and decoding finds each symbol with one table lookup.
+ * The same --order must be given to ArithmeticDecompress.
+ * With --length-prefix (only with order 0), the file starts with the input length (see LengthHeader.hpp)
+ * and no EOF symbol is coded. The same option must be given to ArithmeticDecompress.
+ * With --blocks, the input is split into blocks of N bytes (default 1 MiB) that are compressed
+ * independently on N worker threads, and the output is a block container (see BlockContainer.hpp).
+ * Each block gets its own frequency table, which follows statistics that vary through the input, and
+ * the input is streamed instead of held in memory. Blocks are counted on the reading thread while the
+ * workers code earlier blocks, and the decompressor decodes blocks in parallel.
+ * With --auto-model, each block is coded with whichever model (stored, static of order 0 or 1, adaptive
+ * binary, adaptive, or PPM of order 1 to 3) is estimated to suit it best instead of this application's model.
+ * With --stats, counts of coding events are printed to standard error (see CodingStats.hpp).
  * 
  * Copyright (c) Project Nayuki
  * 
@@ -13,73 +31,132 @@
  * https://github.com/nayuki/Reference-arithmetic-coding
  */
 
+#include <cstddef>
 #include <cstdint>
 #include <cstdlib>
-#include <fstream>
 #include <iostream>
 #include <stdexcept>
+#include <string>
 #include <vector>
 #include "ArithmeticCoder.hpp"
 #include "BitIoStream.hpp"
+#include "BlockCodec.hpp"
+#include "BlockContainer.hpp"
+#include "ByteHistogram.hpp"
+#include "CodingStats.hpp"
+#include "CommandLine.hpp"
+#include "FileStream.hpp"
+#include "FrequencyHeader.hpp"
 #include "FrequencyTable.hpp"
+#include "LengthHeader.hpp"
+#include "ThreadPool.hpp"
 
+using std::uint8_t;
 using std::uint32_t;
 
 
+// Number of bytes to request from the input file per read call.
+static constexpr std::size_t READ_SIZE = 1 << 16;
+
+
 int main(int argc, char *argv[]) {
 	// Handle command line arguments
-	if (argc != 3) {
-		std::cerr << "Usage: " << argv[0] << " InputFile OutputFile" << std::endl;
+	CommandLine cmd(argc, argv);
+	const std::vector<std::string> &args = cmd.getArguments();
+	bool validArgs = args.size() == 2 && cmd.hasOnlyOptions({"stats", "order", "length-prefix", "threads", "blocks", "block-size", "auto-model"});
+	unsigned long order = 0;
+	try {
+		order = cmd.getNumber("order", 0);
+	} catch (const std::exception &e) {
+		std::cerr << e.what() << std::endl;
+		validArgs = false;
+	}
+	if (!validArgs) {
+		std::cerr << "Usage: " << argv[0] << " [--stats] [--order=0|1] [--length-prefix] [--threads=N] [--blocks [--block-size=N] [--auto-model]] InputFile OutputFile" << std::endl;
 		return EXIT_FAILURE;
 	}
-	const char *inputFile  = argv[1];
-	const char *outputFile = argv[2];
-	
-	// Read input file once to compute symbol frequencies
-	std::ifstream in(inputFile, std::ios::binary);
-	SimpleFrequencyTable freqs(std::vector<uint32_t>(257, 0));
-	freqs.increment(256);  // EOF symbol gets a frequency of 1
-	while (true) {
-		int b = in.get();
-		if (b == EOF)
-			break;
-		if (b < 0 || b > 255)
-			throw std::logic_error("Assertion error");
-		freqs.increment(static_cast<uint32_t>(b));
+	const char *inputFile  = args.at(0).c_str();
+	const char *outputFile = args.at(1).c_str();
+	if (order != 0 && order != 1) {
+		std::cerr << "Order must be 0 or 1" << std::endl;
+		return EXIT_FAILURE;
+	}
+	bool lengthPrefix = cmd.hasOption("length-prefix");
+	if (lengthPrefix && (order != 0 || cmd.hasOption("blocks"))) {
+		std::cerr << "--length-prefix is only supported with order 0 and without --blocks" << std::endl;
+		return EXIT_FAILURE;
 	}
 	
-	// Read input file again, compress with arithmetic coding, and write output file
-	in.clear();
-	in.seekg(0);
-	std::ofstream out(outputFile, std::ios::binary);
-	BitOutputStream bout(out);
 	try {
-		
-		// Write frequency table
-		for (uint32_t i = 0; i < 256; i++) {
-			uint32_t freq = freqs.get(i);
-			for (int j = 31; j >= 0; j--)
-				bout.write(static_cast<int>((freq >> j) & 1));  // Big endian
+		InputFileStream in(inputFile);
+		if (cmd.hasOption("blocks")) {
+			// Compress independent blocks on multiple threads into a block container,
+			// which doesn't require the input to be seekable because each block is buffered
+			OutputFileStream out(outputFile);
+			std::size_t blockSize = cmd.getNumber("block-size", BlockCompressor::DEFAULT_BLOCK_SIZE);
+			unsigned int threads = static_cast<unsigned int>(cmd.getNumber("threads", ThreadPool::defaultThreadCount()));
+			BlockCompressor comp = cmd.hasOption("auto-model") ? BlockCompressor(blockSize, threads)
+				: BlockCompressor(order == 1 ? BlockModel::STATIC_ORDER1 : BlockModel::STATIC, 0, blockSize, threads);
+			comp.compress(in, out);
+			out.finish();
+			if (cmd.hasOption("stats"))
+				CodingStats::dump(std::cerr);
+			return EXIT_SUCCESS;
 		}
 		
-		ArithmeticEncoder enc(32, bout);
+		// Read the whole input file into memory, so it can be counted and then coded without reading it again
+		std::vector<uint8_t> data;
 		while (true) {
-			// Read and encode one byte
-			int symbol = in.get();
-			if (symbol == EOF)
+			std::size_t oldSize = data.size();
+			data.resize(oldSize + READ_SIZE);
+			in.read(reinterpret_cast<char *>(&data[oldSize]), static_cast<std::streamsize>(READ_SIZE));
+			data.resize(oldSize + static_cast<std::size_t>(in.gcount()));
+			if (!in)
 				break;
-			if (symbol < 0 || symbol > 255)
-				throw std::logic_error("Assertion error");
-			enc.write(freqs, static_cast<uint32_t>(symbol));
 		}
 		
-		enc.write(freqs, 256);  // EOF
-		enc.finish();  // Flush remaining code bits
+		OutputFileStream out(outputFile);
+		if (order == 1) {
+			// Compress with a table per previous byte value, and write output file
+			std::vector<uint8_t> coded = BlockCodec::compress(BlockModel::STATIC_ORDER1, 0, data.data(), data.size());
+			out.write(reinterpret_cast<const char *>(coded.data()), static_cast<std::streamsize>(coded.size()));
+			out.finish();
+			if (cmd.hasOption("stats"))
+				CodingStats::dump(std::cerr);
+			return EXIT_SUCCESS;
+		}
+		
+		// Compute symbol frequencies, compress with arithmetic coding, and write output file
+		BitOutputStream bout(out);
+		unsigned int threads = static_cast<unsigned int>(cmd.getNumber("threads", ThreadPool::defaultThreadCount()));
+		std::vector<uint32_t> counts = ByteHistogram::count(data.data(), data.size(), threads);
+		std::vector<uint32_t> normalized = FrequencyHeader::normalize(counts);
+		if (lengthPrefix)
+			LengthHeader::write(data.size(), bout);
+		FrequencyHeader::write(normalized, bout);
+		SimpleFrequencyTable freqs(normalized);
+		
+		ArithmeticEncoder enc(32, bout);
+		for (uint8_t b : data)
+			enc.write(freqs, b);
+		
+		if (lengthPrefix)
+			enc.flush();  // End with no bits that the decoder must pad (see LengthHeader.hpp)
+		else {
+			enc.write(freqs, 256);  // EOF
+			enc.finish();  // Flush remaining code bits
+		}
 		bout.finish();
+		out.finish();
+		if (cmd.hasOption("stats"))
+			CodingStats::dump(std::cerr);
 		return EXIT_SUCCESS;
 		
 	} catch (const char *msg) {
 		std::cerr << msg << std::endl;
 		return EXIT_FAILURE;
+	} catch (const std::exception &e) {
+		std::cerr << e.what() << std::endl;
+		return EXIT_FAILURE;
 	}
 }
@@ -1,8 +1,16 @@
 /* 
  * Decompression application using static arithmetic coding
  * 
- * Usage: ArithmeticDecompress InputFile OutputFile
- * This decompresses files generated by the "ArithmeticCompress" application.
+ * Usage: ArithmeticDecompress [--stats] [--order=0|1] [--length-prefix] [--blocks [--threads=N] [--offset=N --length=N]] InputFile OutputFile
+ * Either file name can be "-" to read from standard input or write to standard output.
+ * This decompresses files generated by the "ArithmeticCompress" application,
+ * which must have been given the same --order (default 0) and --length-prefix unless --blocks is used.
+ * With --blocks, the input must be a block container produced by the --blocks mode
+ * of any of the compression applications, since each block records its own model.
+ * The blocks are decoded concurrently on N worker threads. With --offset and --length, only that byte
+ * range of the original data is written, and only the blocks overlapping it are decoded; this needs a
+ * seekable input, and the compressor's block size sets the granularity of the random access.
+ * With --stats, counts of coding events are printed to standard error (see CodingStats.hpp).
  * 
  * Copyright (c) Project Nayuki
  * 
@@ -12,43 +20,104 @@
 
 #include <cstdint>
 #include <cstdlib>
-#include <fstream>
 #include <iostream>
+#include <iterator>
 #include <limits>
+#include <stdexcept>
+#include <string>
 #include <vector>
 #include "ArithmeticCoder.hpp"
 #include "BitIoStream.hpp"
+#include "BlockCodec.hpp"
+#include "BlockContainer.hpp"
+#include "CodingStats.hpp"
+#include "CommandLine.hpp"
+#include "FileStream.hpp"
+#include "FrequencyHeader.hpp"
 #include "FrequencyTable.hpp"
+#include "LengthHeader.hpp"
+#include "ThreadPool.hpp"
 
+using std::uint8_t;
 using std::uint32_t;
 
 
 int main(int argc, char *argv[]) {
 	// Handle command line arguments
-	if (argc != 3) {
-		std::cerr << "Usage: " << argv[0] << " InputFile OutputFile" << std::endl;
+	CommandLine cmd(argc, argv);
+	const std::vector<std::string> &args = cmd.getArguments();
+	bool validArgs = args.size() == 2 && cmd.hasOnlyOptions({"stats", "order", "length-prefix", "blocks", "threads", "offset", "length"})
+			&& cmd.hasOption("offset") == cmd.hasOption("length");
+	unsigned long order = 0;
+	try {
+		order = cmd.getNumber("order", 0);
+	} catch (const std::exception &e) {
+		std::cerr << e.what() << std::endl;
+		validArgs = false;
+	}
+	if (!validArgs) {
+		std::cerr << "Usage: " << argv[0] << " [--stats] [--order=0|1] [--length-prefix] [--blocks [--threads=N] [--offset=N --length=N]] InputFile OutputFile" << std::endl;
+		return EXIT_FAILURE;
+	}
+	const char *inputFile  = args.at(0).c_str();
+	const char *outputFile = args.at(1).c_str();
+	if (order != 0 && order != 1) {
+		std::cerr << "Order must be 0 or 1" << std::endl;
+		return EXIT_FAILURE;
+	}
+	bool lengthPrefix = cmd.hasOption("length-prefix");
+	if (lengthPrefix && (order != 0 || cmd.hasOption("blocks"))) {
+		std::cerr << "--length-prefix is only supported with order 0 and without --blocks" << std::endl;
 		return EXIT_FAILURE;
 	}
-	const char *inputFile  = argv[1];
-	const char *outputFile = argv[2];
 	
 	// Perform file decompression
-	std::ifstream in(inputFile, std::ios::binary);
-	std::ofstream out(outputFile, std::ios::binary);
-	BitInputStream bin(in);
 	try {
-		
-		// Read frequency table
-		SimpleFrequencyTable freqs(std::vector<uint32_t>(257, 0));
-		for (uint32_t i = 0; i < 256; i++) {
-			uint32_t freq = 0;
-			for (int j = 0; j < 32; j++)
-				freq = (freq << 1) | bin.readNoEof();  // Big endian
-			freqs.set(i, freq);
+		InputFileStream in(inputFile);
+		OutputFileStream out(outputFile);
+		if (cmd.hasOption("blocks")) {
+			BlockDecompressor decomp(static_cast<unsigned int>(cmd.getNumber("threads", ThreadPool::defaultThreadCount())));
+			if (cmd.hasOption("offset"))
+				decomp.decompressRange(in, out, cmd.getNumber("offset", 0), cmd.getNumber("length", 0));
+			else
+				decomp.decompress(in, out);
+			out.finish();
+			if (cmd.hasOption("stats"))
+				CodingStats::dump(std::cerr);
+			return EXIT_SUCCESS;
+		}
+		if (order == 1) {
+			// Decode the whole file in memory with the table of each previous byte value
+			std::vector<uint8_t> coded((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+			std::vector<uint8_t> data = BlockCodec::decompress(BlockModel::STATIC_ORDER1, 0, coded.data(), coded.size());
+			out.write(reinterpret_cast<const char *>(data.data()), static_cast<std::streamsize>(data.size()));
+			out.finish();
+			if (cmd.hasOption("stats"))
+				CodingStats::dump(std::cerr);
+			return EXIT_SUCCESS;
 		}
-		freqs.increment(256);  // EOF symbol
 		
-		ArithmeticDecoder dec(32, bin);
+		BitInputStream bin(in);
+		// Read length and frequency table
+		std::uint64_t length = lengthPrefix ? LengthHeader::read(bin) : 0;
+		SimpleFrequencyTable freqs(FrequencyHeader::read(bin));
+		
+		ArithmeticDecoder dec(32, bin, lengthPrefix);
+		if (lengthPrefix) {
+			// Decode exactly the recorded number of bytes
+			for (std::uint64_t i = 0; i < length; i++) {
+				int b = static_cast<int>(dec.read(freqs));
+				if (b == 256)
+					throw std::runtime_error("Unexpected EOF symbol");
+				if (std::numeric_limits<char>::is_signed)
+					b -= (b >> 7) << 8;
+				out.put(static_cast<char>(b));
+			}
+			out.finish();
+			if (cmd.hasOption("stats"))
+				CodingStats::dump(std::cerr);
+			return EXIT_SUCCESS;
+		}
 		while (true) {
 			uint32_t symbol = dec.read(freqs);
 			if (symbol == 256)  // EOF symbol
@@ -58,10 +127,16 @@ int main(int argc, char *argv[]) {
 				b -= (b >> 7) << 8;
 			out.put(static_cast<char>(b));
 		}
+		out.finish();
+		if (cmd.hasOption("stats"))
+			CodingStats::dump(std::cerr);
 		return EXIT_SUCCESS;
 		
 	} catch (const char *msg) {
 		std::cerr << msg << std::endl;
 		return EXIT_FAILURE;
+	} catch (const std::exception &e) {
+		std::cerr << e.what() << std::endl;
+		return EXIT_FAILURE;
 	}
 }
@@ -0,0 +1,417 @@
+/* 
+ * Micro-benchmarks for the arithmetic coder, frequency tables, and PPM model
+ * 
+ * Usage: Benchmark [--symbols=N] [--repeat=N] [--seed=N]
+ * This times the core operations on synthetic symbol sequences and prints one line per
+ * benchmark with the time per coded symbol in nanoseconds. Each benchmark is run several
+ * times and the fastest run is reported, which makes the numbers stable between runs on
+ * an otherwise idle machine. The data is generated from a fixed pseudorandom seed, so every
+ * build sees exactly the same symbols. Build with "make bench". The numbers are only
+ * meaningful relative to each other and to other builds with the same compiler flags.
+ * On Linux, each line also gives hardware performance counter values per symbol (cycles, instructions,
+ * branch misses, L1 data cache read misses, and last-level cache misses) for the fastest run. A counter
+ * that can't be read, such as in a virtual machine without a virtual PMU, is shown as "-".
+ * 
+ * Copyright (c) Project Nayuki
+ * 
+ * https://www.nayuki.io/page/reference-arithmetic-coding
+ * https://github.com/nayuki/Reference-arithmetic-coding
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include "ArithmeticCoder.hpp"
+#include "BitIoStream.hpp"
+#include "BitTreeModel.hpp"
+#include "ByteHistogram.hpp"
+#include "CommandLine.hpp"
+#include "FrequencyQuantizer.hpp"
+#include "FrequencyTable.hpp"
+#include "IntegerModel.hpp"
+#include "PerfCounters.hpp"
+#include "PpmModel.hpp"
+
+using std::uint32_t;
+using std::vector;
+
+
+// A named sequence of symbols drawn from the alphabet [0, alphabetSize).
+struct Distribution final {
+	std::string name;
+	uint32_t alphabetSize;
+	vector<uint32_t> symbols;
+};
+
+
+// The time and performance counter values of one benchmark, per symbol. Unavailable counters are negative.
+struct Measurement final {
+	double nanoseconds;
+	double counters[PerfCounters::NUM_EVENTS];
+};
+
+
+// The highest PPM order to benchmark. Memory usage grows quickly with the order on random data.
+static constexpr int MAX_PPM_ORDER = 3;
+
+
+static vector<Distribution> makeDistributions(std::size_t count, uint32_t seed);
+static Measurement measure(int repeat, std::size_t count, const std::function<void()> &body);
+static void printHeader();
+static void report(const std::string &benchmark, const std::string &distribution, const Measurement &result);
+static std::string encode(const FrequencyTable &freqs, const vector<uint32_t> &symbols);
+static void decode(const FrequencyTable &freqs, const std::string &coded, std::size_t count, vector<uint32_t> &symbols);
+static SimpleFrequencyTable makeHistogram(const Distribution &dist);
+static std::string encodeAdaptive(uint32_t alphabetSize, int treeBits, const vector<uint32_t> &symbols);
+static void decodeAdaptive(uint32_t alphabetSize, int treeBits, const std::string &coded, std::size_t count, vector<uint32_t> &symbols);
+
+
+// Prevents the compiler from discarding the results of the benchmarked computations.
+static volatile uint32_t sink;
+
+// Counts events on the main thread, where all benchmarks run.
+static PerfCounters perfCounters;
+
+
+int main(int argc, char *argv[]) {
+	// Handle command line arguments
+	CommandLine cmd(argc, argv);
+	if (!cmd.getArguments().empty() || !cmd.hasOnlyOptions({"symbols", "repeat", "seed"})) {
+		std::cerr << "Usage: " << argv[0] << " [--symbols=N] [--repeat=N] [--seed=N]" << std::endl;
+		return EXIT_FAILURE;
+	}
+	
+	try {
+		std::size_t count = cmd.getNumber("symbols", 1UL << 20);
+		int repeat = static_cast<int>(cmd.getNumber("repeat", 3));
+		uint32_t seed = static_cast<uint32_t>(cmd.getNumber("seed", 1));
+		if (count == 0 || repeat <= 0)
+			throw std::invalid_argument("Symbol count and repeat count must be positive");
+		
+		if (!perfCounters.isAnyAvailable())
+			std::cerr << "Note: Hardware performance counters are unavailable" << std::endl;
+		printHeader();
+		for (const Distribution &dist : makeDistributions(count, seed)) {
+			const vector<uint32_t> &symbols = dist.symbols;
+			FlatFrequencyTable flat(dist.alphabetSize);
+			SimpleFrequencyTable simple = makeHistogram(dist);
+			SimpleFrequencyTable pow2 = FrequencyQuantizer::toPowerOfTwo(simple, 16);
+			
+			// Static coding with each table type; the decoded symbols are checked after timing
+			const FrequencyTable *tables[] = {&flat, &simple, &pow2};
+			const char *tableNames[] = {"flat", "simple", "simple-pow2"};
+			for (int i = 0; i < 3; i++) {
+				const FrequencyTable &freqs = *tables[i];
+				std::string coded;
+				report(std::string("encoder.write/") + tableNames[i], dist.name, measure(repeat, count, [&]() {
+					coded = encode(freqs, symbols);
+				}));
+				vector<uint32_t> decoded;
+				report(std::string("decoder.read/") + tableNames[i], dist.name, measure(repeat, count, [&]() {
+					decode(freqs, coded, count, decoded);
+				}));
+				if (decoded != symbols)
+					throw std::logic_error("Assertion error");
+			}
+			
+			// The adaptive model's table update pattern: look up the symbol, then count it
+			report("simple.increment+getLow", dist.name, measure(repeat, count, [&]() {
+				SimpleFrequencyTable freqs(FlatFrequencyTable(dist.alphabetSize));
+				uint32_t sum = 0;
+				for (uint32_t sym : symbols) {
+					sum += freqs.getLow(sym);
+					freqs.increment(sym);
+				}
+				sink = sum;
+			}));
+			report("fenwick.increment+getLow", dist.name, measure(repeat, count, [&]() {
+				FenwickFrequencyTable freqs(FlatFrequencyTable(dist.alphabetSize));
+				uint32_t sum = 0;
+				for (uint32_t sym : symbols) {
+					sum += freqs.getLow(sym);
+					freqs.increment(sym);
+				}
+				sink = sum;
+			}));
+			
+			// Equiprobable bits without a table, the alternative to the flat table for every alphabet here
+			int symbolBits = 1;
+			while ((UINT32_C(1) << symbolBits) < dist.alphabetSize)
+				symbolBits++;
+			{
+				std::string coded;
+				report("encoder.writeBits", dist.name, measure(repeat, count, [&]() {
+					std::ostringstream out;
+					BitOutputStream bout(out);
+					ArithmeticEncoder enc(32, bout);
+					for (uint32_t sym : symbols)
+						enc.writeBits(sym, symbolBits);
+					enc.finish();
+					bout.finish();
+					coded = out.str();
+				}));
+				vector<uint32_t> decoded;
+				report("decoder.readBits", dist.name, measure(repeat, count, [&]() {
+					std::istringstream in(coded);
+					BitInputStream bin(in);
+					ArithmeticDecoder dec(32, bin);
+					decoded.clear();
+					for (std::size_t i = 0; i < count; i++)
+						decoded.push_back(dec.readBits(symbolBits));
+				}));
+				if (decoded != symbols)
+					throw std::logic_error("Assertion error");
+			}
+			
+			// Adaptive order-0 coding with a frequency table (tree bits 0) and with binary decisions down a bit tree
+			for (int bits : {0, symbolBits}) {
+				std::string name = bits == 0 ? "simple" : "bittree";
+				std::string coded;
+				report("adaptive.encode/" + name, dist.name, measure(repeat, count, [&]() {
+					coded = encodeAdaptive(dist.alphabetSize, bits, symbols);
+				}));
+				vector<uint32_t> decoded;
+				report("adaptive.decode/" + name, dist.name, measure(repeat, count, [&]() {
+					decodeAdaptive(dist.alphabetSize, bits, coded, count, decoded);
+				}));
+				if (decoded != symbols)
+					throw std::logic_error("Assertion error");
+			}
+			
+			// A column of increasing integers (the running sum of the symbols), coded as deltas with IntegerModel
+			{
+				vector<std::uint64_t> column;
+				std::uint64_t sum = 0;
+				for (uint32_t sym : symbols) {
+					sum += sym;
+					column.push_back(sum);
+				}
+				std::string coded;
+				report("integer.encode/delta", dist.name, measure(repeat, count, [&]() {
+					std::ostringstream out;
+					BitOutputStream bout(out);
+					ArithmeticEncoder enc(32, bout);
+					IntegerModel model(true, false, 2);
+					for (std::uint64_t x : column)
+						model.encode(enc, x);
+					enc.finish();
+					bout.finish();
+					coded = out.str();
+				}));
+				vector<std::uint64_t> decoded;
+				report("integer.decode/delta", dist.name, measure(repeat, count, [&]() {
+					std::istringstream in(coded);
+					BitInputStream bin(in);
+					ArithmeticDecoder dec(32, bin);
+					IntegerModel model(true, false, 2);
+					decoded.clear();
+					for (std::size_t i = 0; i < count; i++)
+						decoded.push_back(model.decode(dec));
+				}));
+				if (decoded != column)
+					throw std::logic_error("Assertion error");
+			}
+			
+			// Counting the frequencies for the static model, per symbol and with ByteHistogram
+			vector<uint8_t> bytes(symbols.begin(), symbols.end());  // Every alphabet fits in a byte
+			report("simple.increment", dist.name, measure(repeat, count, [&]() {
+				SimpleFrequencyTable freqs(vector<uint32_t>(257, 0));
+				for (uint8_t b : bytes)
+					freqs.increment(b);
+				sink = freqs.getTotal();
+			}));
+			report("histogram.count", dist.name, measure(repeat, count, [&]() {
+				sink = ByteHistogram::count(bytes.data(), bytes.size(), 1).at(0);
+			}));
+			
+			// Context updates only, with the history kept the same way as PpmCompress
+			for (int order = 0; order <= MAX_PPM_ORDER; order++) {
+				report("ppm.incrementContexts/order" + std::to_string(order), dist.name, measure(repeat, count, [&]() {
+					PpmModel model(order, 257, 256);
+					vector<uint32_t> history;
+					for (uint32_t sym : symbols) {
+						model.incrementContexts(history, sym);
+						model.pushHistory(history, sym);
+					}
+					sink = model.rootContext->frequencies.getTotal();
+				}));
+			}
+		}
+		return EXIT_SUCCESS;
+		
+	} catch (const std::exception &e) {
+		std::cout << std::flush;
+		std::cerr << e.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+}
+
+
+// Returns the synthetic inputs: bytes with a uniform distribution, bytes with a Zipf distribution
+// (the frequency of the k-th most common symbol is proportional to 1/k), and a binary alphabet
+// where the rarer symbol has probability 1/16. Only std::mt19937 is used for randomness, because
+// the standard library's distribution classes are not guaranteed to give the same values everywhere.
+static vector<Distribution> makeDistributions(std::size_t count, uint32_t seed) {
+	std::mt19937 rand(seed);
+	vector<Distribution> result;
+	
+	Distribution uniform{"uniform", 256, vector<uint32_t>()};
+	for (std::size_t i = 0; i < count; i++)
+		uniform.symbols.push_back(static_cast<uint32_t>(rand() & 0xFF));
+	result.push_back(std::move(uniform));
+	
+	vector<double> cumulative;
+	double total = 0;
+	for (int k = 1; k <= 256; k++) {
+		total += 1.0 / k;
+		cumulative.push_back(total);
+	}
+	Distribution zipf{"zipf", 256, vector<uint32_t>()};
+	for (std::size_t i = 0; i < count; i++) {
+		double x = rand() / 4294967296.0 * total;
+		uint32_t sym = 0;
+		while (sym < 255 && cumulative.at(sym) <= x)
+			sym++;
+		zipf.symbols.push_back(sym);
+	}
+	result.push_back(std::move(zipf));
+	
+	Distribution binary{"binary", 2, vector<uint32_t>()};
+	for (std::size_t i = 0; i < count; i++)
+		binary.symbols.push_back((rand() & 0xF) == 0 ? 1 : 0);
+	result.push_back(std::move(binary));
+	return result;
+}
+
+
+// Runs the given body the given number of times and returns the fastest run's
+// duration and counter values, each divided by the given symbol count.
+static Measurement measure(int repeat, std::size_t count, const std::function<void()> &body) {
+	Measurement best;
+	best.nanoseconds = INFINITY;
+	for (int i = 0; i < repeat; i++) {
+		auto start = std::chrono::steady_clock::now();
+		perfCounters.start();
+		body();
+		perfCounters.stop();
+		auto elapsed = std::chrono::steady_clock::now() - start;
+		double nanos = std::chrono::duration<double, std::nano>(elapsed).count();
+		if (nanos < best.nanoseconds) {
+			best.nanoseconds = nanos;
+			for (int j = 0; j < PerfCounters::NUM_EVENTS; j++)
+				best.counters[j] = perfCounters.get(static_cast<PerfCounters::Event>(j));
+		}
+	}
+	best.nanoseconds /= count;
+	for (double &x : best.counters) {
+		if (x >= 0)
+			x /= count;
+	}
+	return best;
+}
+
+
+static void printHeader() {
+	std::printf("%-36s %-8s %10s", "benchmark", "data", "ns/symbol");
+	for (int i = 0; i < PerfCounters::NUM_EVENTS; i++)
+		std::printf(" %13s", PerfCounters::getName(static_cast<PerfCounters::Event>(i)));
+	std::printf("\n");
+}
+
+
+static void report(const std::string &benchmark, const std::string &distribution, const Measurement &result) {
+	std::printf("%-36s %-8s %10.2f", benchmark.c_str(), distribution.c_str(), result.nanoseconds);
+	for (double x : result.counters) {
+		if (x >= 0)
+			std::printf(" %13.3f", x);
+		else
+			std::printf(" %13s", "-");
+	}
+	std::printf("\n");
+	std::fflush(stdout);
+}
+
+
+static std::string encode(const FrequencyTable &freqs, const vector<uint32_t> &symbols) {
+	std::ostringstream out;
+	BitOutputStream bout(out);
+	ArithmeticEncoder enc(32, bout);
+	for (uint32_t sym : symbols)
+		enc.write(freqs, sym);
+	enc.finish();
+	bout.finish();
+	return out.str();
+}
+
+
+static void decode(const FrequencyTable &freqs, const std::string &coded, std::size_t count, vector<uint32_t> &symbols) {
+	std::istringstream in(coded);
+	BitInputStream bin(in);
+	ArithmeticDecoder dec(32, bin);
+	symbols.clear();
+	for (std::size_t i = 0; i < count; i++)
+		symbols.push_back(dec.read(freqs));
+}
+
+
+// Returns a table of the given distribution's symbol counts, with every count at least 1.
+static SimpleFrequencyTable makeHistogram(const Distribution &dist) {
+	SimpleFrequencyTable result(vector<uint32_t>(dist.alphabetSize, 1));
+	for (uint32_t sym : dist.symbols)
+		result.increment(sym);
+	return result;
+}
+
+
+// Codes the given symbols with an adaptive SimpleFrequencyTable if treeBits is 0, otherwise with a BitTreeModel.
+static std::string encodeAdaptive(uint32_t alphabetSize, int treeBits, const vector<uint32_t> &symbols) {
+	std::ostringstream out;
+	BitOutputStream bout(out);
+	ArithmeticEncoder enc(32, bout);
+	if (treeBits == 0) {
+		SimpleFrequencyTable freqs((FlatFrequencyTable(alphabetSize)));
+		for (uint32_t sym : symbols) {
+			enc.write(freqs, sym);
+			freqs.increment(sym);
+		}
+	} else {
+		BitTreeModel model(treeBits);
+		for (uint32_t sym : symbols)
+			model.encodeSymbol(enc, sym);
+	}
+	enc.finish();
+	bout.finish();
+	return out.str();
+}
+
+
+static void decodeAdaptive(uint32_t alphabetSize, int treeBits, const std::string &coded, std::size_t count, vector<uint32_t> &symbols) {
+	std::istringstream in(coded);
+	BitInputStream bin(in);
+	ArithmeticDecoder dec(32, bin);
+	symbols.clear();
+	if (treeBits == 0) {
+		SimpleFrequencyTable freqs((FlatFrequencyTable(alphabetSize)));
+		for (std::size_t i = 0; i < count; i++) {
+			uint32_t sym = dec.read(freqs);
+			freqs.increment(sym);
+			symbols.push_back(sym);
+		}
+	} else {
+		BitTreeModel model(treeBits);
+		for (std::size_t i = 0; i < count; i++)
+			symbols.push_back(model.decodeSymbol(dec));
+	}
+}
@@ -14,7 +14,8 @@
 BitInputStream::BitInputStream(std::istream &in) :
 	input(in),
 	currentByte(0),
-	numBitsRemaining(0) {}
+	numBitsRemaining(0),
+	numBytesRead(0) {}
 	
 	
 int BitInputStream::read() {
@@ -27,6 +28,7 @@ int BitInputStream::read() {
 		if (currentByte < 0 || currentByte > 255)
 			throw std::logic_error("Assertion error");
 		numBitsRemaining = 8;
+		numBytesRead++;
 	}
 	if (numBitsRemaining <= 0)
 		throw std::logic_error("Assertion error");
@@ -44,10 +46,41 @@ int BitInputStream::readNoEof() {
 }
 
 
+void BitInputStream::alignToByte() {
+	numBitsRemaining = 0;
+}
+
+
+void BitInputStream::saveState(CheckpointWriter &out) const {
+	out.write(numBytesRead);
+	out.write(static_cast<std::uint64_t>(currentByte + 1));  // So that -1 (end of stream) is stored as 0
+	out.write(static_cast<std::uint64_t>(numBitsRemaining));
+}
+
+
+void BitInputStream::loadState(CheckpointReader &in) {
+	std::uint64_t bytes = in.read(std::numeric_limits<std::streamoff>::max());
+	int byte = static_cast<int>(in.read(256)) - 1;
+	int bits = static_cast<int>(in.read(7));
+	if (byte == -1 && bits != 0)
+		throw std::runtime_error("Invalid bit stream state in checkpoint");
+	
+	// Seek relative to the current position, which also works when some bytes were read since construction
+	input.clear();
+	input.seekg(static_cast<std::streamoff>(bytes) - static_cast<std::streamoff>(numBytesRead), std::ios_base::cur);
+	if (!input)
+		throw std::runtime_error("Cannot seek in input");
+	currentByte = byte;
+	numBitsRemaining = bits;
+	numBytesRead = bytes;
+}
+
+
 BitOutputStream::BitOutputStream(std::ostream &out) :
 	output(out),
 	currentByte(0),
-	numBitsFilled(0) {}
+	numBitsFilled(0),
+	numBytesWritten(0) {}
 
 
 void BitOutputStream::write(int b) {
@@ -62,6 +95,7 @@ void BitOutputStream::write(int b) {
 		output.put(static_cast<char>(currentByte));
 		currentByte = 0;
 		numBitsFilled = 0;
+		numBytesWritten++;
 	}
 }
 
@@ -70,3 +104,29 @@ void BitOutputStream::finish() {
 	while (numBitsFilled != 0)
 		write(0);
 }
+
+
+std::uint64_t BitOutputStream::getByteCount() const {
+	return numBytesWritten;
+}
+
+
+void BitOutputStream::saveState(CheckpointWriter &out) const {
+	out.write(numBytesWritten);
+	out.write(static_cast<std::uint64_t>(currentByte));
+	out.write(static_cast<std::uint64_t>(numBitsFilled));
+}
+
+
+void BitOutputStream::loadState(CheckpointReader &in) {
+	if (numBytesWritten != 0 || numBitsFilled != 0)
+		throw std::logic_error("Stream already written to");
+	std::uint64_t bytes = in.read();
+	int byte = static_cast<int>(in.read(127));
+	int bits = static_cast<int>(in.read(7));
+	if ((byte >> bits) != 0)
+		throw std::runtime_error("Invalid bit stream state in checkpoint");
+	numBytesWritten = bytes;
+	currentByte = byte;
+	numBitsFilled = bits;
+}
@@ -8,8 +8,10 @@
 
 #pragma once
 
+#include <cstdint>
 #include <istream>
 #include <ostream>
+#include "Checkpoint.hpp"
 
 
 /* 
@@ -29,6 +31,9 @@ class BitInputStream final {
 	// Number of remaining bits in the current byte, always between 0 and 7 (inclusive).
 	private: int numBitsRemaining;
 	
+	// Number of bytes read from the underlying stream by this object.
+	private: std::uint64_t numBytesRead;
+	
 	
 	/*---- Constructor ----*/
 	
@@ -47,6 +52,21 @@ class BitInputStream final {
 	// if the end of stream is reached. The end of stream always occurs on a byte boundary.
 	public: int readNoEof();
 	
+	
+	// Discards the unread bits of the current byte, so that the next bit read is the first bit of
+	// the next byte. This never reads from the underlying stream. Does nothing on a byte boundary.
+	public: void alignToByte();
+	
+	
+	// Appends the number of bytes read and the unread bits of the current byte to the given checkpoint.
+	public: void saveState(CheckpointWriter &out) const;
+	
+	
+	// Restores the state saved by saveState(), which must come from a stream whose underlying stream started at
+	// the same position as this one's did. The underlying stream is seeked to just after the bytes read then,
+	// so it must be seekable. Throws an exception if the checkpoint is malformed or the seek fails.
+	public: void loadState(CheckpointReader &in);
+	
 };
 
 
@@ -69,6 +89,9 @@ class BitOutputStream final {
 	// Number of accumulated bits in the current byte, always between 0 and 7 (inclusive).
 	private: int numBitsFilled;
 	
+	// Number of whole bytes written to the underlying stream by this object.
+	private: std::uint64_t numBytesWritten;
+	
 	
 	/*---- Constructor ----*/
 	
@@ -88,4 +111,19 @@ class BitOutputStream final {
 	// method merely writes data to the underlying output stream but does not close it.
 	public: void finish();
 	
+	
+	// Returns the number of whole bytes written to the underlying stream by this object.
+	public: std::uint64_t getByteCount() const;
+	
+	
+	// Appends the number of bytes written and the bits of the partial current byte to the given checkpoint.
+	public: void saveState(CheckpointWriter &out) const;
+	
+	
+	// Restores the state saved by saveState() into this stream, which must not have been written to, and whose
+	// underlying stream must already end just after the bytes counted in the checkpoint (such as the same file
+	// truncated to that length and opened for appending). Later bits then complete the partial byte.
+	// Throws an exception if the checkpoint is malformed.
+	public: void loadState(CheckpointReader &in);
+	
 };
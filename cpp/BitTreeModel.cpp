@@ -0,0 +1,59 @@
+/* 
+ * Reference arithmetic coding
+ * Copyright (c) Project Nayuki
+ * 
+ * https://www.nayuki.io/page/reference-arithmetic-coding
+ * https://github.com/nayuki/Reference-arithmetic-coding
+ */
+
+#include <cstddef>
+#include <stdexcept>
+#include "BitTreeModel.hpp"
+
+using std::uint16_t;
+using std::uint32_t;
+
+
+// The probability scale, which corresponds to certainty.
+static constexpr uint32_t PROBABILITY_ONE = UINT32_C(1) << ArithmeticCoderBase::PROBABILITY_BITS;
+
+
+BitTreeModel::BitTreeModel(int bits) :
+		numBits(bits) {
+	if (bits < 1 || bits > 16)
+		throw std::domain_error("Number of bits out of range");
+	probabilities.assign(static_cast<std::size_t>(1) << numBits, static_cast<uint16_t>(PROBABILITY_ONE / 2));
+}
+
+
+void BitTreeModel::encodeSymbol(ArithmeticEncoder &enc, uint32_t symbol) {
+	if (symbol >> numBits != 0)
+		throw std::domain_error("Symbol out of range");
+	uint32_t node = 1;
+	for (int i = numBits - 1; i >= 0; i--) {
+		int bit = static_cast<int>((symbol >> i) & 1);
+		enc.writeBit(probabilities[node], bit);
+		adapt(node, bit);
+		node = node << 1 | bit;
+	}
+}
+
+
+uint32_t BitTreeModel::decodeSymbol(ArithmeticDecoder &dec) {
+	uint32_t node = 1;
+	for (int i = 0; i < numBits; i++) {
+		int bit = dec.readBit(probabilities[node]);
+		adapt(node, bit);
+		node = node << 1 | bit;
+	}
+	return node - (UINT32_C(1) << numBits);  // Remove the root's leading 1
+}
+
+
+void BitTreeModel::adapt(uint32_t node, int bit) {
+	uint16_t &prob = probabilities[node];
+	if (bit == 0)
+		prob += static_cast<uint16_t>((PROBABILITY_ONE - prob) >> ADAPTATION_SHIFT);
+	else
+		prob -= static_cast<uint16_t>(prob >> ADAPTATION_SHIFT);
+}
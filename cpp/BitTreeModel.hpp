@@ -0,0 +1,62 @@
+/* 
+ * Reference arithmetic coding
+ * Copyright (c) Project Nayuki
+ * 
+ * https://www.nayuki.io/page/reference-arithmetic-coding
+ * https://github.com/nayuki/Reference-arithmetic-coding
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "ArithmeticCoder.hpp"
+
+
+/* 
+ * An adaptive model of symbols in the range [0, 2^numBits), which codes each symbol as numBits binary
+ * decisions from the most significant bit down. Each decision has its own adaptive probability, chosen by
+ * the bits coded so far, so the decisions form a binary tree of 2^numBits - 1 nodes (255 for bytes), which
+ * together are equivalent to an adaptive order-0 frequency table. After each decision, the probability
+ * moves 1/2^ADAPTATION_SHIFT of the way towards the coded bit, which favors recent statistics, and unlike
+ * SimpleFrequencyTable::increment() takes constant time. With numBits = 1, this is a single adaptive bit.
+ */
+class BitTreeModel final {
+	
+	/*---- Constants ----*/
+	
+	// Controls the adaptation speed; smaller values adapt faster but predict stationary data less accurately.
+	public: static constexpr int ADAPTATION_SHIFT = 5;
+	
+	
+	/*---- Fields ----*/
+	
+	private: int numBits;
+	
+	// The probability of a 0 at each node, in units of 2^-ArithmeticCoderBase::PROBABILITY_BITS. Node 1 is the
+	// root, and the children of node i are 2i and 2i+1 (index 0 is unused). The update rule keeps every value
+	// in a range that excludes 0 and 1, because a step is rounded down to zero before either limit is reached.
+	private: std::vector<std::uint16_t> probabilities;
+	
+	
+	/*---- Constructor ----*/
+	
+	// Constructs a model of symbols of the given number of bits, which must be in the range [1, 16],
+	// where every bit starts with a probability of 1/2.
+	public: explicit BitTreeModel(int bits);
+	
+	
+	/*---- Methods ----*/
+	
+	// Encodes the given symbol and then adapts the probabilities of the nodes on its path.
+	public: void encodeSymbol(ArithmeticEncoder &enc, std::uint32_t symbol);
+	
+	
+	// Decodes and returns the next symbol, adapting the probabilities like encodeSymbol().
+	public: std::uint32_t decodeSymbol(ArithmeticDecoder &dec);
+	
+	
+	// Moves the probability of the given node towards the given bit.
+	private: void adapt(std::uint32_t node, int bit);
+	
+};
@@ -0,0 +1,275 @@
+/* 
+ * Reference arithmetic coding
+ * Copyright (c) Project Nayuki
+ * 
+ * https://www.nayuki.io/page/reference-arithmetic-coding
+ * https://github.com/nayuki/Reference-arithmetic-coding
+ */
+
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include "ArithmeticCoder.hpp"
+#include "BitIoStream.hpp"
+#include "BitTreeModel.hpp"
+#include "BlockCodec.hpp"
+#include "ByteHistogram.hpp"
+#include "FrequencyHeader.hpp"
+#include "FrequencyTable.hpp"
+#include "PpmModel.hpp"
+
+using std::uint8_t;
+using std::uint32_t;
+using std::vector;
+
+
+static void compressStatic(const vector<uint32_t> &counts, const uint8_t *data, std::size_t len, BitOutputStream &out);
+static void compressAdaptive(const uint8_t *data, std::size_t len, BitOutputStream &out);
+static void compressPpm(int order, const uint8_t *data, std::size_t len, BitOutputStream &out);
+static void compressStaticOrder1(const uint8_t *data, std::size_t len, BitOutputStream &out);
+static void compressAdaptiveBinary(const uint8_t *data, std::size_t len, BitOutputStream &out);
+static void decompressStatic(BitInputStream &in, vector<uint8_t> &out, std::size_t maxLen);
+static void decompressAdaptive(BitInputStream &in, vector<uint8_t> &out, std::size_t maxLen);
+static void decompressPpm(int order, BitInputStream &in, vector<uint8_t> &out, std::size_t maxLen);
+static void decompressStaticOrder1(BitInputStream &in, vector<uint8_t> &out, std::size_t maxLen);
+static void decompressAdaptiveBinary(BitInputStream &in, vector<uint8_t> &out, std::size_t maxLen);
+static void appendDecoded(vector<uint8_t> &out, uint32_t symbol, std::size_t maxLen);
+
+
+vector<uint8_t> BlockCodec::compress(BlockModel model, int ppmOrder, const uint8_t *data, std::size_t len) {
+	if (model == BlockModel::PPM && (ppmOrder < -1 || ppmOrder > MAX_PPM_ORDER))
+		throw std::domain_error("PPM model order out of range");
+	if (model == BlockModel::STORED)
+		return vector<uint8_t>(data, data + len);
+	std::ostringstream out;
+	BitOutputStream bout(out);
+	switch (model) {
+		case BlockModel::STATIC  :  compressStatic(ByteHistogram::count(data, len, 1), data, len, bout);  break;
+		case BlockModel::ADAPTIVE:  compressAdaptive(data, len, bout);  break;
+		case BlockModel::PPM     :  compressPpm(ppmOrder, data, len, bout);  break;
+		case BlockModel::STATIC_ORDER1:  compressStaticOrder1(data, len, bout);  break;
+		case BlockModel::ADAPTIVE_BINARY:  compressAdaptiveBinary(data, len, bout);  break;
+		default:  throw std::domain_error("Unknown block model");
+	}
+	bout.finish();
+	std::string temp = out.str();
+	return vector<uint8_t>(temp.begin(), temp.end());
+}
+
+
+vector<uint8_t> BlockCodec::compressWithCounts(const vector<uint32_t> &counts, const uint8_t *data, std::size_t len) {
+	if (counts.size() != 256)
+		throw std::invalid_argument("Expected 256 byte counts");
+	std::ostringstream out;
+	BitOutputStream bout(out);
+	compressStatic(counts, data, len, bout);
+	bout.finish();
+	std::string temp = out.str();
+	return vector<uint8_t>(temp.begin(), temp.end());
+}
+
+
+vector<uint8_t> BlockCodec::decompress(BlockModel model, int ppmOrder, const uint8_t *data, std::size_t len, std::size_t maxLength) {
+	if (model == BlockModel::PPM && (ppmOrder < -1 || ppmOrder > MAX_PPM_ORDER))
+		throw std::domain_error("PPM model order out of range");
+	if (model == BlockModel::STORED) {
+		if (len > maxLength)
+			throw std::runtime_error("Block decodes to more than its recorded length");
+		return vector<uint8_t>(data, data + len);
+	}
+	std::istringstream in(std::string(reinterpret_cast<const char *>(data), len));
+	BitInputStream bin(in);
+	vector<uint8_t> result;
+	switch (model) {
+		case BlockModel::STATIC  :  decompressStatic  (bin, result, maxLength);  break;
+		case BlockModel::ADAPTIVE:  decompressAdaptive(bin, result, maxLength);  break;
+		case BlockModel::PPM     :  decompressPpm(ppmOrder, bin, result, maxLength);  break;
+		case BlockModel::STATIC_ORDER1:  decompressStaticOrder1(bin, result, maxLength);  break;
+		case BlockModel::ADAPTIVE_BINARY:  decompressAdaptiveBinary(bin, result, maxLength);  break;
+		default:  throw std::domain_error("Unknown block model");
+	}
+	return result;
+}
+
+
+BlockModel BlockCodec::toModel(uint8_t id) {
+	if (id > static_cast<uint8_t>(BlockModel::ADAPTIVE_BINARY))
+		throw std::runtime_error("Unknown block model in compressed data");
+	return static_cast<BlockModel>(id);
+}
+
+
+static void compressStatic(const vector<uint32_t> &counts, const uint8_t *data, std::size_t len, BitOutputStream &out) {
+	vector<uint32_t> normalized = FrequencyHeader::normalize(counts);
+	FrequencyHeader::write(normalized, out);
+	SimpleFrequencyTable freqs(normalized);
+	
+	ArithmeticEncoder enc(BlockCodec::STATE_BITS, out);
+	for (std::size_t i = 0; i < len; i++)
+		enc.write(freqs, data[i]);
+	enc.write(freqs, 256);  // EOF
+	enc.finish();  // Flush remaining code bits
+}
+
+
+static void compressAdaptive(const uint8_t *data, std::size_t len, BitOutputStream &out) {
+	SimpleFrequencyTable freqs(FlatFrequencyTable(257));
+	ArithmeticEncoder enc(BlockCodec::STATE_BITS, out);
+	for (std::size_t i = 0; i < len; i++) {
+		enc.write(freqs, data[i]);
+		freqs.increment(data[i]);
+	}
+	enc.write(freqs, 256);  // EOF
+	enc.finish();  // Flush remaining code bits
+}
+
+
+static void compressPpm(int order, const uint8_t *data, std::size_t len, BitOutputStream &out) {
+	ArithmeticEncoder enc(BlockCodec::STATE_BITS, out);
+	PpmModel model(order, 257, 256, true, true);
+	vector<uint32_t> history;
+	for (std::size_t i = 0; i < len; i++) {
+		uint32_t sym = data[i];
+		model.encodeSymbol(enc, history, sym);
+		model.incrementContexts(history, sym);
+		model.pushHistory(history, sym);
+	}
+	model.encodeSymbol(enc, history, 256);  // EOF
+	enc.finish();  // Flush remaining code bits
+}
+
+
+static void decompressStatic(BitInputStream &in, vector<uint8_t> &out, std::size_t maxLen) {
+	SimpleFrequencyTable freqs(FrequencyHeader::read(in));
+	ArithmeticDecoder dec(BlockCodec::STATE_BITS, in);
+	while (true) {
+		uint32_t symbol = dec.read(freqs);
+		if (symbol == 256)  // EOF symbol
+			break;
+		appendDecoded(out, symbol, maxLen);
+	}
+}
+
+
+static void decompressAdaptive(BitInputStream &in, vector<uint8_t> &out, std::size_t maxLen) {
+	SimpleFrequencyTable freqs(FlatFrequencyTable(257));
+	ArithmeticDecoder dec(BlockCodec::STATE_BITS, in);
+	while (true) {
+		uint32_t symbol = dec.read(freqs);
+		if (symbol == 256)  // EOF symbol
+			break;
+		appendDecoded(out, symbol, maxLen);
+		freqs.increment(symbol);
+	}
+}
+
+
+static void decompressPpm(int order, BitInputStream &in, vector<uint8_t> &out, std::size_t maxLen) {
+	ArithmeticDecoder dec(BlockCodec::STATE_BITS, in);
+	PpmModel model(order, 257, 256, true, true);
+	vector<uint32_t> history;
+	while (true) {
+		uint32_t symbol = model.decodeSymbol(dec, history);
+		if (symbol == 256)  // EOF symbol
+			break;
+		appendDecoded(out, symbol, maxLen);
+		model.incrementContexts(history, symbol);
+		model.pushHistory(history, symbol);
+	}
+}
+
+
+// Writes a bit for each previous byte value saying whether its context has a table, then the normalized
+// table of each such context, then each byte coded with the table of the byte before it (or of byte
+// value 0 for the first byte), then the EOF symbol in the context of the last byte.
+static void compressStaticOrder1(const uint8_t *data, std::size_t len, BitOutputStream &out) {
+	vector<vector<uint32_t> > counts(256);
+	uint8_t prev = 0;
+	for (std::size_t i = 0; i < len; i++) {
+		if (counts[prev].empty())
+			counts[prev].resize(256, 0);
+		counts[prev][data[i]]++;
+		prev = data[i];
+	}
+	if (counts[prev].empty())
+		counts[prev].resize(256, 0);  // The context that codes EOF always needs a table
+	
+	// Write frequency tables
+	for (const vector<uint32_t> &ctxCounts : counts)
+		out.write(ctxCounts.empty() ? 0 : 1);
+	vector<std::unique_ptr<SimpleFrequencyTable> > tables(256);
+	for (int i = 0; i < 256; i++) {
+		if (!counts[i].empty()) {
+			vector<uint32_t> normalized = FrequencyHeader::normalize(counts[i], BlockCodec::ORDER1_TOTAL_BITS);
+			FrequencyHeader::write(normalized, out);
+			tables[i].reset(new SimpleFrequencyTable(normalized));
+		}
+	}
+	
+	ArithmeticEncoder enc(BlockCodec::STATE_BITS, out);
+	prev = 0;
+	for (std::size_t i = 0; i < len; i++) {
+		enc.write(*tables[prev], data[i]);
+		prev = data[i];
+	}
+	enc.write(*tables[prev], 256);  // EOF
+	enc.finish();  // Flush remaining code bits
+}
+
+
+static void decompressStaticOrder1(BitInputStream &in, vector<uint8_t> &out, std::size_t maxLen) {
+	// Read frequency tables
+	bool present[256];
+	for (bool &p : present)
+		p = in.readNoEof() == 1;
+	vector<std::unique_ptr<LookupFrequencyTable> > tables(256);
+	for (int i = 0; i < 256; i++) {
+		if (present[i])
+			tables[i].reset(new LookupFrequencyTable(SimpleFrequencyTable(FrequencyHeader::read(in))));
+	}
+	
+	ArithmeticDecoder dec(BlockCodec::STATE_BITS, in);
+	uint8_t prev = 0;
+	while (true) {
+		if (!tables[prev])
+			throw std::runtime_error("Missing frequency table in compressed data");
+		uint32_t symbol = dec.read(*tables[prev]);
+		if (symbol == 256)  // EOF symbol
+			break;
+		appendDecoded(out, symbol, maxLen);
+		prev = static_cast<uint8_t>(symbol);
+	}
+}
+
+
+// Codes each byte as an adaptive end-of-data decision (0) followed by the byte's 8 bits down
+// a bit tree, and ends with an end-of-data decision of 1, like AdaptiveArithmeticCompress --binary.
+static void compressAdaptiveBinary(const uint8_t *data, std::size_t len, BitOutputStream &out) {
+	BitTreeModel endModel(1);
+	BitTreeModel byteModel(8);
+	ArithmeticEncoder enc(BlockCodec::STATE_BITS, out);
+	for (std::size_t i = 0; i < len; i++) {
+		endModel.encodeSymbol(enc, 0);
+		byteModel.encodeSymbol(enc, data[i]);
+	}
+	endModel.encodeSymbol(enc, 1);  // EOF
+	enc.finish();  // Flush remaining code bits
+}
+
+
+static void decompressAdaptiveBinary(BitInputStream &in, vector<uint8_t> &out, std::size_t maxLen) {
+	BitTreeModel endModel(1);
+	BitTreeModel byteModel(8);
+	ArithmeticDecoder dec(BlockCodec::STATE_BITS, in);
+	while (endModel.decodeSymbol(dec) == 0)
+		appendDecoded(out, byteModel.decodeSymbol(dec), maxLen);
+}
+
+
+// Appends the given decoded byte, or throws an exception if the block would exceed its maximum length.
+static void appendDecoded(vector<uint8_t> &out, uint32_t symbol, std::size_t maxLen) {
+	if (out.size() >= maxLen)
+		throw std::runtime_error("Block decodes to more than its recorded length");
+	out.push_back(static_cast<uint8_t>(symbol));
+}
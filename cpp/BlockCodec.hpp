@@ -0,0 +1,76 @@
+/* 
+ * Reference arithmetic coding
+ * Copyright (c) Project Nayuki
+ * 
+ * https://www.nayuki.io/page/reference-arithmetic-coding
+ * https://github.com/nayuki/Reference-arithmetic-coding
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+/* 
+ * The probability models that a block of bytes can be coded with. The numeric values are stored in
+ * compressed data, so they must never change.
+ */
+enum class BlockModel : std::uint8_t {
+	STATIC   = 0,  // Frequency table of the block followed by static arithmetic coding, as in ArithmeticCompress
+	ADAPTIVE = 1,  // Order-0 adaptive arithmetic coding, as in AdaptiveArithmeticCompress
+	PPM      = 2,  // Prediction by partial matching at some model order, as in PpmCompress
+	STORED   = 3,  // The bytes verbatim without any coding, for data that doesn't compress
+	STATIC_ORDER1 = 4,  // A static frequency table for each previous byte value, as in ArithmeticCompress --order=1
+	ADAPTIVE_BINARY = 5,  // Order-0 adaptive binary decisions down a bit tree, as in AdaptiveArithmeticCompress --binary
+};
+
+
+
+/* 
+ * Compresses and decompresses a single in-memory block of bytes, independently of any other block.
+ * A compressed block has exactly the format that the corresponding command-line tool produces for a
+ * whole file with the same content (including the EOF symbol), so each block can be decoded on its own.
+ * The one difference is that the PPM model codes EOF at order -1 as a cheap binary decision (see PpmModel).
+ * A stored block is just a copy of the bytes, whose length must be known from elsewhere.
+ */
+class BlockCodec final {
+	
+	/*---- Constants ----*/
+	
+	// Number of arithmetic coder state bits for all models, the same as in the command-line tools.
+	public: static constexpr int STATE_BITS = 32;
+	
+	// Each table of the STATIC_ORDER1 model is normalized to a total of at most 2^ORDER1_TOTAL_BITS,
+	// which bounds the size of the decoder's lookup tables and lets sparse contexts use small totals.
+	public: static constexpr int ORDER1_TOTAL_BITS = 12;
+	
+	// The highest PPM model order that blocks can be coded with. The context tree grows by up to
+	// one context per order per byte, so higher orders cost too much memory and time to be useful.
+	public: static constexpr int MAX_PPM_ORDER = 8;
+	
+	
+	/*---- Methods ----*/
+	
+	// Compresses the given bytes with the given model and returns the coded bytes.
+	// The PPM model order must be in the range [-1, MAX_PPM_ORDER], and is ignored for other models.
+	public: static std::vector<std::uint8_t> compress(BlockModel model, int ppmOrder, const std::uint8_t *data, std::size_t len);
+	
+	
+	// Compresses the given bytes with the static model, like compress(), but using the given 256 byte counts
+	// of the data, which the caller has already computed (for example with ByteHistogram on another thread).
+	public: static std::vector<std::uint8_t> compressWithCounts(const std::vector<std::uint32_t> &counts, const std::uint8_t *data, std::size_t len);
+	
+	
+	// Decompresses the given coded bytes, which must have been produced by compress()
+	// with the same model and order, and returns the original bytes. Throws an exception
+	// as soon as the data decodes to more than maxLength bytes, so damaged data whose
+	// length is known from elsewhere can't make the decoder run on without bound.
+	public: static std::vector<std::uint8_t> decompress(BlockModel model, int ppmOrder, const std::uint8_t *data, std::size_t len, std::size_t maxLength=SIZE_MAX);
+	
+	
+	// Returns the model with the given stored identifier, or throws an exception if it is unknown.
+	public: static BlockModel toModel(std::uint8_t id);
+	
+};
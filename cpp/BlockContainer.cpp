@@ -0,0 +1,556 @@
+/* 
+ * Reference arithmetic coding
+ * Copyright (c) Project Nayuki
+ * 
+ * https://www.nayuki.io/page/reference-arithmetic-coding
+ * https://github.com/nayuki/Reference-arithmetic-coding
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+#include "BlockContainer.hpp"
+#include "ByteHistogram.hpp"
+#include "CostEstimator.hpp"
+#include "Crc32c.hpp"
+#include "ThreadPool.hpp"
+
+using std::uint8_t;
+using std::uint32_t;
+using std::uint64_t;
+using std::vector;
+
+
+static const char HEADER_MAGIC[4] = {'A', 'C', 'B', 'K'};
+static const char FOOTER_MAGIC[4] = {'A', 'C', 'B', 'X'};
+static constexpr int FORMAT_VERSION = 1;
+static constexpr uint64_t HEADER_SIZE = 16;
+static constexpr uint64_t RECORD_HEADER_SIZE = 18;
+static constexpr uint64_t INDEX_ENTRY_SIZE = 8;
+static constexpr uint64_t FOOTER_SIZE = 20;
+static constexpr uint8_t MODEL_PER_BLOCK_ID = 0xFF;
+
+// The compressor stores a block verbatim whenever coding wouldn't make it smaller, so no valid record's coded
+// length exceeds its uncompressed length. The slack only keeps this bound from being tighter than it needs to be.
+static constexpr uint32_t MAX_CODED_OVERHEAD = 16;
+
+// Coded bytes are read this many at a time, so that a truncated stream fails before a large buffer is filled.
+static constexpr std::size_t READ_CHUNK_SIZE = 1 << 16;
+
+
+// The fields of a block record header. All zeros denotes the end marker.
+struct RecordHeader {
+	uint8_t modelId;
+	std::int8_t ppmOrder;
+	uint32_t rawLength;
+	uint32_t codedLength;
+	uint32_t rawCrc;
+	uint32_t codedCrc;
+};
+
+
+// A block that has been read and handed to a worker thread, but not yet written out.
+struct PendingBlock {
+	RecordHeader header;
+	vector<uint8_t> input;  // Released once coded
+	vector<uint32_t> counts;  // Byte counts of the input, if the reading thread computed them
+	vector<uint8_t> output;
+	std::future<void> done;
+};
+
+
+static void writeRecordHeader(std::ostream &out, const RecordHeader &rec);
+static RecordHeader readRecordHeader(std::istream &in, uint32_t blockSize);
+static uint32_t computeCodedCrc(const RecordHeader &rec, const vector<uint8_t> &coded);
+static void checkPpmOrder(BlockModel model, int ppmOrder);
+static std::future<void> submitDecode(ThreadPool &pool, PendingBlock *blk);
+static void checkTrailer(std::istream &in, const vector<uint8_t> &indexBytes, uint64_t totalLength);
+static void appendUint32(vector<uint8_t> &buf, uint32_t val);
+static void appendUint64(vector<uint8_t> &buf, uint64_t val);
+static uint32_t getUint32(const uint8_t *buf);
+static uint64_t getUint64(const uint8_t *buf);
+static void readFully(std::istream &in, uint8_t *buf, std::size_t len);
+static void readChunked(std::istream &in, vector<uint8_t> &buf, std::size_t len);
+
+
+/*---- Block compressor ----*/
+
+BlockCompressor::BlockCompressor(BlockModel mdl, int order, std::size_t blkSize, unsigned int threads) :
+		modelPerBlock(false),
+		model(mdl),
+		ppmOrder(order),
+		blockSize(blkSize),
+		numThreads(threads) {
+	if (blkSize < 1 || blkSize > UINT32_MAX)
+		throw std::domain_error("Block size out of range");
+	if (threads < 1)
+		throw std::domain_error("Number of threads must be positive");
+	if (mdl == BlockModel::PPM && (order < -1 || order > BlockCodec::MAX_PPM_ORDER))
+		throw std::domain_error("PPM model order out of range");
+}
+
+
+BlockCompressor::BlockCompressor(std::size_t blkSize, unsigned int threads) :
+		BlockCompressor(BlockModel::STATIC, 0, blkSize, threads) {
+	modelPerBlock = true;
+}
+
+
+void BlockCompressor::compress(std::istream &in, std::ostream &out) const {
+	// Write header
+	vector<uint8_t> header(HEADER_MAGIC, HEADER_MAGIC + sizeof(HEADER_MAGIC));
+	header.push_back(FORMAT_VERSION);
+	header.push_back(modelPerBlock ? MODEL_PER_BLOCK_ID : static_cast<uint8_t>(model));
+	header.push_back(static_cast<uint8_t>(!modelPerBlock && model == BlockModel::PPM ? ppmOrder : 0));
+	header.push_back(static_cast<uint8_t>(BlockCodec::STATE_BITS));
+	appendUint32(header, static_cast<uint32_t>(blockSize));
+	appendUint32(header, Crc32c::compute(header.data(), header.size()));
+	out.write(reinterpret_cast<const char *>(header.data()), static_cast<std::streamsize>(header.size()));
+	
+	vector<uint8_t> indexBytes;
+	uint64_t totalLength = 0;
+	std::deque<std::unique_ptr<PendingBlock> > pending;
+	const std::size_t maxPending = static_cast<std::size_t>(numThreads) * 2;
+	
+	// Writes the oldest pending block once its worker has finished
+	auto writeOldest = [&]() {
+		PendingBlock &blk = *pending.front();
+		blk.done.get();  // Rethrows any exception from the worker
+		writeRecordHeader(out, blk.header);
+		out.write(reinterpret_cast<const char *>(blk.output.data()), static_cast<std::streamsize>(blk.output.size()));
+		appendUint32(indexBytes, blk.header.rawLength);
+		appendUint32(indexBytes, blk.header.codedLength);
+		totalLength += blk.header.rawLength;
+		pending.pop_front();
+	};
+	
+	{
+		// The pool is destroyed (waiting for all workers) before the pending blocks they reference
+		ThreadPool pool(numThreads);
+		while (true) {
+			std::unique_ptr<PendingBlock> blk(new PendingBlock);
+			blk->input.resize(blockSize);
+			in.read(reinterpret_cast<char *>(blk->input.data()), static_cast<std::streamsize>(blockSize));
+			blk->input.resize(static_cast<std::size_t>(in.gcount()));
+			if (blk->input.empty())
+				break;
+			blk->header.rawLength = static_cast<uint32_t>(blk->input.size());
+			// For the static model, count the bytes here so that histogramming this block
+			// overlaps with the workers coding the previous blocks
+			if (!modelPerBlock && model == BlockModel::STATIC)
+				blk->counts = ByteHistogram::count(blk->input.data(), blk->input.size(), 1);
+			
+			PendingBlock *p = blk.get();  // Stays valid while the block is in the deque
+			bool select = modelPerBlock;
+			BlockModel mdl = model;
+			int order = ppmOrder;
+			p->done = pool.submit([p, select, mdl, order]() mutable {
+				if (select) {
+					ModelChoice choice = CostEstimator::selectModel(p->input.data(), p->input.size());
+					mdl = choice.model;
+					order = choice.ppmOrder;
+				} else if (CostEstimator::isIncompressible(mdl, order, p->input.data(), p->input.size()))
+					mdl = BlockModel::STORED;
+				p->header.rawCrc = Crc32c::compute(p->input.data(), p->input.size());
+				if (mdl == BlockModel::STATIC && !p->counts.empty())
+					p->output = BlockCodec::compressWithCounts(p->counts, p->input.data(), p->input.size());
+				else
+					p->output = BlockCodec::compress(mdl, order, p->input.data(), p->input.size());
+				if (p->output.size() >= p->input.size()) {  // The estimate was too optimistic
+					mdl = BlockModel::STORED;
+					p->output = BlockCodec::compress(mdl, order, p->input.data(), p->input.size());
+				}
+				vector<uint8_t>().swap(p->input);
+				p->header.modelId = static_cast<uint8_t>(mdl);
+				p->header.ppmOrder = static_cast<std::int8_t>(mdl == BlockModel::PPM ? order : 0);
+				if (p->output.size() > UINT32_MAX)
+					throw std::length_error("Coded block too long");
+				p->header.codedLength = static_cast<uint32_t>(p->output.size());
+				p->header.codedCrc = computeCodedCrc(p->header, p->output);
+			});
+			pending.push_back(std::move(blk));
+			if (pending.size() >= maxPending)
+				writeOldest();
+		}
+		while (!pending.empty())
+			writeOldest();
+	}
+	
+	// Write end marker, block index, and footer
+	writeRecordHeader(out, RecordHeader{0, 0, 0, 0, 0, 0});
+	if (indexBytes.size() / INDEX_ENTRY_SIZE > UINT32_MAX)
+		throw std::length_error("Too many blocks");
+	vector<uint8_t> trailer(indexBytes);
+	appendUint64(trailer, totalLength);
+	appendUint32(trailer, static_cast<uint32_t>(indexBytes.size() / INDEX_ENTRY_SIZE));
+	appendUint32(trailer, Crc32c::compute(trailer.data(), trailer.size()));
+	trailer.insert(trailer.end(), FOOTER_MAGIC, FOOTER_MAGIC + sizeof(FOOTER_MAGIC));
+	out.write(reinterpret_cast<const char *>(trailer.data()), static_cast<std::streamsize>(trailer.size()));
+	if (!out)
+		throw std::runtime_error("Error writing compressed data");
+}
+
+
+/*---- Block decompressor ----*/
+
+BlockDecompressor::BlockDecompressor(unsigned int threads) :
+		numThreads(threads) {
+	if (threads < 1)
+		throw std::domain_error("Number of threads must be positive");
+}
+
+
+void BlockDecompressor::decompress(std::istream &in, std::ostream &out) const {
+	uint32_t blockSize = readHeader(in).blockSize;
+	
+	// Validate the whole container up front if the input allows it
+	vector<BlockIndexEntry> expected;
+	bool haveIndex = false;
+	std::streampos start = in.tellg();
+	if (start != std::streampos(-1)) {
+		expected = readIndex(in);
+		in.clear();
+		in.seekg(start);
+		if (!in)
+			throw std::runtime_error("Cannot seek in compressed data");
+		haveIndex = true;
+	}
+	
+	vector<uint8_t> indexBytes;
+	uint64_t totalLength = 0;
+	std::deque<std::unique_ptr<PendingBlock> > pending;
+	const std::size_t maxPending = static_cast<std::size_t>(numThreads) * 2;
+	
+	// Writes the oldest pending block once its worker has finished
+	auto writeOldest = [&]() {
+		PendingBlock &blk = *pending.front();
+		blk.done.get();  // Rethrows any exception from the worker
+		out.write(reinterpret_cast<const char *>(blk.output.data()), static_cast<std::streamsize>(blk.output.size()));
+		pending.pop_front();
+	};
+	
+	{
+		// The pool is destroyed (waiting for all workers) before the pending blocks they reference
+		ThreadPool pool(numThreads);
+		while (true) {
+			std::unique_ptr<PendingBlock> blk(new PendingBlock);
+			blk->header = readRecordHeader(in, blockSize);
+			const RecordHeader &rec = blk->header;
+			if (rec.codedLength == 0)
+				break;  // End marker
+			std::size_t i = indexBytes.size() / INDEX_ENTRY_SIZE;
+			if (haveIndex && (i >= expected.size() || expected[i].rawLength != rec.rawLength || expected[i].codedLength != rec.codedLength))
+				throw std::runtime_error("Block index mismatch");
+			appendUint32(indexBytes, rec.rawLength);
+			appendUint32(indexBytes, rec.codedLength);
+			totalLength += rec.rawLength;
+			
+			readChunked(in, blk->input, rec.codedLength);
+			blk->done = submitDecode(pool, blk.get());
+			pending.push_back(std::move(blk));
+			if (pending.size() >= maxPending)
+				writeOldest();
+		}
+		while (!pending.empty())
+			writeOldest();
+	}
+	
+	checkTrailer(in, indexBytes, totalLength);
+	if (!out)
+		throw std::runtime_error("Error writing decompressed data");
+}
+
+
+void BlockDecompressor::decompressRange(std::istream &in, std::ostream &out, uint64_t offset, uint64_t length) const {
+	uint32_t blockSize = readHeader(in).blockSize;
+	vector<BlockIndexEntry> index = readIndex(in);
+	uint64_t totalLength = index.empty() ? 0 : index.back().rawOffset + index.back().rawLength;
+	if (offset > totalLength || length > totalLength - offset)
+		throw std::out_of_range("Range extends past end of data");
+	if (length == 0)
+		return;
+	uint64_t end = offset + length;
+	
+	// Find the first block that contains the byte at 'offset'
+	auto first = std::upper_bound(index.cbegin(), index.cend(), offset,
+		[](uint64_t off, const BlockIndexEntry &entry) { return off < entry.rawOffset + entry.rawLength; });
+	
+	std::deque<std::unique_ptr<PendingBlock> > pending;
+	std::deque<uint64_t> pendingOffsets;
+	const std::size_t maxPending = static_cast<std::size_t>(numThreads) * 2;
+	
+	// Writes the overlapping part of the oldest pending block once its worker has finished
+	auto writeOldest = [&]() {
+		PendingBlock &blk = *pending.front();
+		blk.done.get();  // Rethrows any exception from the worker
+		uint64_t blockStart = pendingOffsets.front();
+		uint64_t from = std::max(offset, blockStart) - blockStart;
+		uint64_t to = std::min(end, blockStart + blk.header.rawLength) - blockStart;
+		out.write(reinterpret_cast<const char *>(blk.output.data() + from), static_cast<std::streamsize>(to - from));
+		pending.pop_front();
+		pendingOffsets.pop_front();
+	};
+	
+	{
+		// The pool is destroyed (waiting for all workers) before the pending blocks they reference
+		ThreadPool pool(numThreads);
+		for (auto it = first; it != index.cend() && it->rawOffset < end; ++it) {
+			in.clear();
+			in.seekg(static_cast<std::streamoff>(it->recordOffset));
+			std::unique_ptr<PendingBlock> blk(new PendingBlock);
+			blk->header = readRecordHeader(in, blockSize);
+			if (blk->header.rawLength != it->rawLength || blk->header.codedLength != it->codedLength)
+				throw std::runtime_error("Block index mismatch");
+			readChunked(in, blk->input, it->codedLength);
+			blk->done = submitDecode(pool, blk.get());
+			pending.push_back(std::move(blk));
+			pendingOffsets.push_back(it->rawOffset);
+			if (pending.size() >= maxPending)
+				writeOldest();
+		}
+		while (!pending.empty())
+			writeOldest();
+	}
+	if (!out)
+		throw std::runtime_error("Error writing decompressed data");
+}
+
+
+BlockContainerInfo BlockDecompressor::readHeader(std::istream &in) {
+	uint8_t header[HEADER_SIZE];
+	readFully(in, header, sizeof(header));
+	if (std::memcmp(header, HEADER_MAGIC, sizeof(HEADER_MAGIC)) != 0)
+		throw std::runtime_error("Not a block container");
+	if (Crc32c::compute(header, HEADER_SIZE - 4) != getUint32(header + HEADER_SIZE - 4))
+		throw std::runtime_error("Header checksum mismatch");
+	BlockContainerInfo result;
+	result.formatVersion = header[4];
+	if (result.formatVersion != FORMAT_VERSION)
+		throw std::runtime_error("Unsupported block container version");
+	result.modelPerBlock = header[5] == MODEL_PER_BLOCK_ID;
+	result.model = result.modelPerBlock ? BlockModel::STATIC : BlockCodec::toModel(header[5]);
+	result.ppmOrder = static_cast<std::int8_t>(header[6]);
+	if (!result.modelPerBlock)
+		checkPpmOrder(result.model, result.ppmOrder);
+	result.stateBits = header[7];
+	if (result.stateBits != BlockCodec::STATE_BITS)
+		throw std::runtime_error("Unsupported arithmetic coder state size");
+	result.blockSize = getUint32(header + 8);
+	return result;
+}
+
+
+vector<BlockIndexEntry> BlockDecompressor::readIndex(std::istream &in) {
+	in.seekg(0, std::ios_base::end);
+	std::streamoff fileSize = in.tellg();
+	if (!in || fileSize < static_cast<std::streamoff>(HEADER_SIZE + RECORD_HEADER_SIZE + FOOTER_SIZE))
+		throw std::runtime_error("Block container too short");
+	uint64_t size = static_cast<uint64_t>(fileSize);
+	
+	// Read footer
+	uint8_t footer[FOOTER_SIZE];
+	in.seekg(static_cast<std::streamoff>(size - FOOTER_SIZE));
+	readFully(in, footer, sizeof(footer));
+	if (std::memcmp(footer + 16, FOOTER_MAGIC, sizeof(FOOTER_MAGIC)) != 0)
+		throw std::runtime_error("Malformed block container footer");
+	uint64_t totalLength = getUint64(footer);
+	uint32_t numBlocks = getUint32(footer + 8);
+	uint64_t indexSize = numBlocks * INDEX_ENTRY_SIZE;
+	if (indexSize > size - HEADER_SIZE - RECORD_HEADER_SIZE - FOOTER_SIZE)
+		throw std::runtime_error("Block index too long");
+	
+	// Read index and check its checksum, which also covers the footer's length fields
+	uint64_t indexStart = size - FOOTER_SIZE - indexSize;
+	vector<uint8_t> indexBytes(indexSize + 12);
+	in.seekg(static_cast<std::streamoff>(indexStart));
+	readFully(in, indexBytes.data(), indexSize);
+	std::memcpy(indexBytes.data() + indexSize, footer, 12);
+	if (Crc32c::compute(indexBytes.data(), indexBytes.size()) != getUint32(footer + 12))
+		throw std::runtime_error("Block index checksum mismatch");
+	
+	// Compute offsets
+	vector<BlockIndexEntry> result;
+	result.reserve(numBlocks);
+	uint64_t rawOffset = 0;
+	uint64_t recordOffset = HEADER_SIZE;
+	for (uint32_t i = 0; i < numBlocks; i++) {
+		BlockIndexEntry entry;
+		entry.rawOffset = rawOffset;
+		entry.rawLength = getUint32(&indexBytes[i * INDEX_ENTRY_SIZE]);
+		entry.recordOffset = recordOffset;
+		entry.codedLength = getUint32(&indexBytes[i * INDEX_ENTRY_SIZE + 4]);
+		if (entry.codedLength == 0)
+			throw std::runtime_error("Malformed block index");
+		rawOffset += entry.rawLength;
+		recordOffset += RECORD_HEADER_SIZE + entry.codedLength;
+		result.push_back(entry);
+	}
+	if (recordOffset + RECORD_HEADER_SIZE != indexStart)
+		throw std::runtime_error("Block index does not match container size");
+	if (rawOffset != totalLength)
+		throw std::runtime_error("Block index does not match total length");
+	return result;
+}
+
+
+vector<BlockIndexEntry> BlockDecompressor::verify(std::istream &in) {
+	in.seekg(0);
+	uint32_t blockSize = readHeader(in).blockSize;
+	vector<BlockIndexEntry> index = readIndex(in);
+	vector<uint8_t> coded;
+	for (const BlockIndexEntry &entry : index) {
+		in.clear();
+		in.seekg(static_cast<std::streamoff>(entry.recordOffset));
+		RecordHeader rec = readRecordHeader(in, blockSize);
+		if (rec.rawLength != entry.rawLength || rec.codedLength != entry.codedLength)
+			throw std::runtime_error("Block index mismatch");
+		readChunked(in, coded, rec.codedLength);
+		if (computeCodedCrc(rec, coded) != rec.codedCrc)
+			throw std::runtime_error("Block checksum mismatch");
+	}
+	if (readRecordHeader(in, blockSize).codedLength != 0)
+		throw std::runtime_error("Malformed end marker");
+	return index;
+}
+
+
+/*---- Helper functions ----*/
+
+static void writeRecordHeader(std::ostream &out, const RecordHeader &rec) {
+	vector<uint8_t> buf;
+	buf.push_back(rec.modelId);
+	buf.push_back(static_cast<uint8_t>(rec.ppmOrder));
+	appendUint32(buf, rec.rawLength);
+	appendUint32(buf, rec.codedLength);
+	appendUint32(buf, rec.rawCrc);
+	appendUint32(buf, rec.codedCrc);
+	out.write(reinterpret_cast<const char *>(buf.data()), static_cast<std::streamsize>(buf.size()));
+}
+
+
+// Reads a record header and checks its lengths against the container's block size, so that a damaged
+// header (whose checksum is only verified along with the coded bytes) can't make the caller allocate much.
+static RecordHeader readRecordHeader(std::istream &in, uint32_t blockSize) {
+	uint8_t buf[RECORD_HEADER_SIZE];
+	readFully(in, buf, sizeof(buf));
+	RecordHeader result;
+	result.modelId = buf[0];
+	result.ppmOrder = static_cast<std::int8_t>(buf[1]);
+	result.rawLength = getUint32(buf + 2);
+	result.codedLength = getUint32(buf + 6);
+	result.rawCrc = getUint32(buf + 10);
+	result.codedCrc = getUint32(buf + 14);
+	if (result.codedLength == 0) {
+		for (uint8_t b : buf) {
+			if (b != 0)
+				throw std::runtime_error("Malformed end marker");
+		}
+	} else {
+		// Reject parameters that no compressor writes, before any buffer or model is made from them
+		if (result.rawLength == 0 || result.rawLength > blockSize)
+			throw std::runtime_error("Invalid block length in compressed data");
+		if (result.codedLength > result.rawLength + static_cast<uint64_t>(MAX_CODED_OVERHEAD))
+			throw std::runtime_error("Invalid coded block length in compressed data");
+		checkPpmOrder(BlockCodec::toModel(result.modelId), result.ppmOrder);
+	}
+	return result;
+}
+
+
+// Returns the checksum that covers both the record header fields before it and the coded bytes,
+// so that a damaged model, order or length is detected before the block is decoded.
+static uint32_t computeCodedCrc(const RecordHeader &rec, const vector<uint8_t> &coded) {
+	vector<uint8_t> buf;
+	buf.push_back(rec.modelId);
+	buf.push_back(static_cast<uint8_t>(rec.ppmOrder));
+	appendUint32(buf, rec.rawLength);
+	appendUint32(buf, rec.codedLength);
+	appendUint32(buf, rec.rawCrc);
+	return Crc32c::update(Crc32c::compute(buf.data(), buf.size()), coded.data(), coded.size());
+}
+
+
+// Throws an exception if the given PPM order is out of range for the PPM model, or nonzero for any other model.
+static void checkPpmOrder(BlockModel model, int ppmOrder) {
+	if (model == BlockModel::PPM ? ppmOrder < -1 || ppmOrder > BlockCodec::MAX_PPM_ORDER : ppmOrder != 0)
+		throw std::runtime_error("Invalid PPM model order in compressed data");
+}
+
+
+// Queues the decoding of the given block, whose header and coded bytes have been read.
+static std::future<void> submitDecode(ThreadPool &pool, PendingBlock *blk) {
+	BlockModel model = BlockCodec::toModel(blk->header.modelId);
+	return pool.submit([blk, model]() {
+		const RecordHeader &rec = blk->header;
+		// Reject damaged coded data before decoding it into garbage
+		if (computeCodedCrc(rec, blk->input) != rec.codedCrc)
+			throw std::runtime_error("Block checksum mismatch");
+		blk->output = BlockCodec::decompress(model, rec.ppmOrder, blk->input.data(), blk->input.size(), rec.rawLength);
+		vector<uint8_t>().swap(blk->input);
+		if (blk->output.size() != rec.rawLength)
+			throw std::runtime_error("Block length mismatch");
+		if (Crc32c::compute(blk->output.data(), blk->output.size()) != rec.rawCrc)
+			throw std::runtime_error("Decompressed block checksum mismatch");
+	});
+}
+
+
+// Reads the block index and footer that follow the end marker, and checks them against the
+// index entries accumulated while streaming through the blocks.
+static void checkTrailer(std::istream &in, const vector<uint8_t> &indexBytes, uint64_t totalLength) {
+	vector<uint8_t> expected(indexBytes);
+	appendUint64(expected, totalLength);
+	appendUint32(expected, static_cast<uint32_t>(indexBytes.size() / INDEX_ENTRY_SIZE));
+	appendUint32(expected, Crc32c::compute(expected.data(), expected.size()));
+	expected.insert(expected.end(), FOOTER_MAGIC, FOOTER_MAGIC + sizeof(FOOTER_MAGIC));
+	vector<uint8_t> actual(expected.size());
+	readFully(in, actual.data(), actual.size());
+	if (actual != expected)
+		throw std::runtime_error("Block index or footer mismatch");
+}
+
+
+static void appendUint32(vector<uint8_t> &buf, uint32_t val) {
+	for (int i = 24; i >= 0; i -= 8)
+		buf.push_back(static_cast<uint8_t>(val >> i));  // Big endian
+}
+
+
+static void appendUint64(vector<uint8_t> &buf, uint64_t val) {
+	appendUint32(buf, static_cast<uint32_t>(val >> 32));
+	appendUint32(buf, static_cast<uint32_t>(val));
+}
+
+
+static uint32_t getUint32(const uint8_t *buf) {
+	return static_cast<uint32_t>(buf[0]) << 24 | static_cast<uint32_t>(buf[1]) << 16
+		| static_cast<uint32_t>(buf[2]) << 8 | buf[3];  // Big endian
+}
+
+
+static uint64_t getUint64(const uint8_t *buf) {
+	return static_cast<uint64_t>(getUint32(buf)) << 32 | getUint32(buf + 4);
+}
+
+
+static void readFully(std::istream &in, uint8_t *buf, std::size_t len) {
+	in.read(reinterpret_cast<char *>(buf), static_cast<std::streamsize>(len));
+	if (static_cast<std::size_t>(in.gcount()) != len)
+		throw std::runtime_error("Unexpected end of compressed data");
+}
+
+
+// Replaces the contents of the given buffer with the next len bytes of the stream, growing it only as the bytes arrive.
+static void readChunked(std::istream &in, vector<uint8_t> &buf, std::size_t len) {
+	buf.clear();
+	while (buf.size() < len) {
+		std::size_t start = buf.size();
+		std::size_t n = std::min(len - start, READ_CHUNK_SIZE);
+		buf.resize(start + n);
+		readFully(in, buf.data() + start, n);
+	}
+}
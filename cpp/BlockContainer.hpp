@@ -0,0 +1,180 @@
+/* 
+ * Reference arithmetic coding
+ * Copyright (c) Project Nayuki
+ * 
+ * https://www.nayuki.io/page/reference-arithmetic-coding
+ * https://github.com/nayuki/Reference-arithmetic-coding
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <vector>
+#include "BlockCodec.hpp"
+
+
+/* 
+ * The self-describing fields of a block container, which can be read without decoding any block.
+ * All integers in the container are unsigned big endian. The container format (version 1) is:
+ * - Header (16 bytes): magic "ACBK", format version (uint8), model identifier (uint8, or 255 if the model
+ *   was chosen per block), PPM model order (int8), arithmetic coder state bits (uint8), nominal uncompressed
+ *   block size (uint32), and the CRC-32C of the preceding 12 bytes (uint32).
+ * - Zero or more block records, each being an 18-byte record header and then the coded bytes from
+ *   BlockCodec. The record header is: model identifier (uint8), PPM model order (int8), uncompressed
+ *   length (uint32), coded length (uint32), CRC-32C of the uncompressed bytes (uint32), and CRC-32C
+ *   of the preceding 14 bytes of the record header followed by the coded bytes (uint32). The PPM model
+ *   order is in the range [-1, BlockCodec::MAX_PPM_ORDER] for the PPM model and 0 for the others.
+ *   Every block except the last has the nominal uncompressed length.
+ * - End marker: a record header of 18 zero bytes (a real block is never 0 bytes long).
+ * - Block index: for each block in order, its uncompressed length (uint32) and coded length (uint32).
+ * - Footer (20 bytes): total uncompressed length (uint64), number of blocks (uint32), CRC-32C of the
+ *   block index and the preceding two footer fields (uint32), and magic "ACBX".
+ * The per-record lengths let a reader stream through the blocks sequentially, and the trailing
+ * index lets a reader with a seekable input locate any block without scanning the whole stream.
+ * The header's model is the one the compressor was asked to use; each record names its own model.
+ * A block that would not get smaller by coding is stored verbatim instead (with the stored model),
+ * so the container is never more than the fixed overhead of the header, records, and index larger
+ * than its input.
+ */
+struct BlockContainerInfo final {
+	
+	int formatVersion;
+	
+	// Whether the compressor chose a model for each block. If so, 'model' and 'ppmOrder' are meaningless.
+	bool modelPerBlock;
+	
+	BlockModel model;
+	
+	int ppmOrder;
+	
+	int stateBits;
+	
+	std::uint32_t blockSize;
+	
+};
+
+
+
+/* 
+ * Compresses a byte stream as a sequence of independently coded blocks, using several threads.
+ * The output is a block container as described at BlockContainerInfo.
+ */
+class BlockCompressor final {
+	
+	/*---- Constants ----*/
+	
+	// The block size that the command-line tools use when none is specified.
+	public: static constexpr std::size_t DEFAULT_BLOCK_SIZE = 1 << 20;
+	
+	
+	/*---- Fields ----*/
+	
+	// Whether to choose the model for each block with CostEstimator::selectModel() instead of using 'model'.
+	private: bool modelPerBlock;
+	
+	private: BlockModel model;
+	
+	// Only used when the model is PPM.
+	private: int ppmOrder;
+	
+	// Number of uncompressed bytes per block, which is in the range [1, UINT32_MAX].
+	private: std::size_t blockSize;
+	
+	// Number of worker threads, which is at least 1.
+	private: unsigned int numThreads;
+	
+	
+	/*---- Constructor ----*/
+	
+	// Constructs a compressor that codes every block with the given model.
+	public: explicit BlockCompressor(BlockModel mdl, int order, std::size_t blkSize, unsigned int threads);
+	
+	
+	// Constructs a compressor that codes each block with the model that is estimated to suit it best.
+	public: explicit BlockCompressor(std::size_t blkSize, unsigned int threads);
+	
+	
+	/*---- Methods ----*/
+	
+	// Reads the given input stream to the end and writes the block container to the given output stream.
+	// Blocks are compressed concurrently but written in order, and at most a few blocks per thread are
+	// held in memory at any time, so the input can be of unbounded length.
+	public: void compress(std::istream &in, std::ostream &out) const;
+	
+};
+
+
+
+/* 
+ * The location of one block within a block container, as listed in the trailing block index.
+ */
+struct BlockIndexEntry final {
+	
+	// Offset of the block's first byte in the decompressed data.
+	std::uint64_t rawOffset;
+	
+	std::uint32_t rawLength;
+	
+	// Offset of the block's record (including its record header) in the container.
+	std::uint64_t recordOffset;
+	
+	// Length of the coded bytes, excluding the record header.
+	std::uint32_t codedLength;
+	
+};
+
+
+
+/* 
+ * Decompresses a block container produced by BlockCompressor, using several threads.
+ */
+class BlockDecompressor final {
+	
+	/*---- Fields ----*/
+	
+	// Number of worker threads, which is at least 1.
+	private: unsigned int numThreads;
+	
+	
+	/*---- Constructor ----*/
+	
+	public: explicit BlockDecompressor(unsigned int threads);
+	
+	
+	/*---- Methods ----*/
+	
+	// Reads the given block container stream and writes the original bytes to the given output stream.
+	// Blocks are decoded concurrently but written in order, and at most a few blocks per thread are held
+	// in memory at any time, so the output can go to a pipe. If the input is seekable, the trailing index
+	// is read first so that a truncated or inconsistent container is rejected before any output is written.
+	// Throws an exception if the container is malformed, a checksum doesn't match, or a block fails to
+	// decode to its recorded length.
+	public: void decompress(std::istream &in, std::ostream &out) const;
+	
+	
+	// Writes only the given range of the original bytes, decoding just the blocks that overlap it.
+	// Block boundaries are the random access points, so the amount of work is at most the range length
+	// plus two block sizes. The input must be seekable. Throws an exception if the range extends past
+	// the end of the original data.
+	public: void decompressRange(std::istream &in, std::ostream &out, std::uint64_t offset, std::uint64_t length) const;
+	
+	
+	// Reads and validates the header at the current position of the given container stream.
+	// Throws an exception if the data is not a block container or has an unsupported version.
+	public: static BlockContainerInfo readHeader(std::istream &in);
+	
+	
+	// Reads and validates the trailing block index of the given seekable container stream,
+	// and returns one entry per block in order. The stream position is left unspecified.
+	public: static std::vector<BlockIndexEntry> readIndex(std::istream &in);
+	
+	
+	// Checks the structure of the given seekable container stream and the checksum of every block's
+	// coded bytes, without decoding any block. Returns the block index, or throws an exception if
+	// any part of the container is damaged.
+	public: static std::vector<BlockIndexEntry> verify(std::istream &in);
+	
+};
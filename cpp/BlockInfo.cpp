@@ -0,0 +1,87 @@
+/* 
+ * Inspection application for block containers
+ * 
+ * Usage: BlockInfo InputFile
+ * This prints the self-describing fields of a block container produced by the --blocks mode of
+ * the compression applications, and checks the header, block index, and the checksum of every
+ * block's coded data without decoding any block. The exit status is zero if the container is intact.
+ * The input must be a seekable file.
+ * 
+ * Copyright (c) Project Nayuki
+ * 
+ * https://www.nayuki.io/page/reference-arithmetic-coding
+ * https://github.com/nayuki/Reference-arithmetic-coding
+ */
+
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+#include "BlockContainer.hpp"
+#include "FileStream.hpp"
+
+using std::uint64_t;
+
+
+static const char *modelName(BlockModel model);
+
+
+int main(int argc, char *argv[]) {
+	// Handle command line arguments
+	if (argc != 2) {
+		std::cerr << "Usage: " << argv[0] << " InputFile" << std::endl;
+		return EXIT_FAILURE;
+	}
+	const char *inputFile = argv[1];
+	
+	try {
+		InputFileStream in(inputFile);
+		if (!in.isSeekable())
+			throw std::runtime_error("Input file must be seekable");
+		BlockContainerInfo info = BlockDecompressor::readHeader(in);
+		std::cout << "Format version: " << info.formatVersion << std::endl;
+		std::cout << "Model: ";
+		if (info.modelPerBlock)
+			std::cout << "chosen per block";
+		else {
+			std::cout << modelName(info.model);
+			if (info.model == BlockModel::PPM)
+				std::cout << " (order " << info.ppmOrder << ")";
+		}
+		std::cout << std::endl;
+		std::cout << "State bits: " << info.stateBits << std::endl;
+		std::cout << "Block size: " << info.blockSize << std::endl;
+		
+		std::vector<BlockIndexEntry> index = BlockDecompressor::verify(in);
+		uint64_t rawLength = 0;
+		uint64_t codedLength = 0;
+		for (const BlockIndexEntry &entry : index) {
+			rawLength += entry.rawLength;
+			codedLength += entry.codedLength;
+		}
+		std::cout << "Blocks: " << index.size() << std::endl;
+		std::cout << "Uncompressed length: " << rawLength << std::endl;
+		std::cout << "Coded length: " << codedLength << std::endl;
+		std::cout << "Checksums: OK" << std::endl;
+		return EXIT_SUCCESS;
+		
+	} catch (const std::exception &e) {
+		std::cout << std::flush;
+		std::cerr << e.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+}
+
+
+static const char *modelName(BlockModel model) {
+	switch (model) {
+		case BlockModel::STATIC  :  return "static";
+		case BlockModel::ADAPTIVE:  return "adaptive";
+		case BlockModel::PPM     :  return "PPM";
+		case BlockModel::STORED  :  return "stored";
+		case BlockModel::STATIC_ORDER1:  return "static order-1";
+		case BlockModel::ADAPTIVE_BINARY:  return "adaptive binary";
+		default:  throw std::logic_error("Assertion error");
+	}
+}
@@ -0,0 +1,93 @@
+/* 
+ * Reference arithmetic coding
+ * Copyright (c) Project Nayuki
+ * 
+ * https://www.nayuki.io/page/reference-arithmetic-coding
+ * https://github.com/nayuki/Reference-arithmetic-coding
+ */
+
+#include <algorithm>
+#include <future>
+#include <stdexcept>
+#include "ByteHistogram.hpp"
+#include "ThreadPool.hpp"
+
+using std::uint8_t;
+using std::uint32_t;
+using std::uint64_t;
+using std::vector;
+
+
+// The number of interleaved sub-histograms that a chunk is counted into.
+static constexpr int NUM_SUBHISTOGRAMS = 4;
+
+// Each sub-histogram counts at most this many bytes of a chunk before being added to the totals, so its
+// 32-bit counts cannot overflow.
+static constexpr std::size_t MAX_SEGMENT_SIZE = std::size_t(1) << 30;
+
+
+static void countChunk(const uint8_t *data, std::size_t len, uint64_t result[256]);
+
+
+vector<uint32_t> ByteHistogram::count(const uint8_t *data, std::size_t len, unsigned int threads) {
+	if (threads < 1)
+		throw std::domain_error("Number of threads must be positive");
+	
+	std::size_t numChunks = threads;
+	if (len < MIN_PARALLEL_SIZE || threads == 1)
+		numChunks = 1;
+	vector<uint64_t> totals(numChunks * 256, 0);
+	if (numChunks == 1)
+		countChunk(data, len, totals.data());
+	else {
+		// The pool is destroyed (waiting for all workers) before the totals they write to
+		ThreadPool pool(threads);
+		vector<std::future<void> > done;
+		std::size_t chunkSize = (len + numChunks - 1) / numChunks;
+		for (std::size_t i = 0; i < numChunks; i++) {
+			std::size_t start = i * chunkSize;
+			std::size_t end = std::min(start + chunkSize, len);
+			uint64_t *out = &totals[i * 256];
+			done.push_back(pool.submit([data, start, end, out]() {
+				countChunk(data + start, end - start, out);
+			}));
+		}
+		for (std::future<void> &f : done)
+			f.get();  // Rethrows any exception from the worker
+	}
+	
+	vector<uint32_t> result(256);
+	for (int i = 0; i < 256; i++) {
+		uint64_t sum = 0;
+		for (std::size_t j = 0; j < numChunks; j++)
+			sum += totals[j * 256 + i];
+		if (sum > UINT32_MAX)
+			throw std::overflow_error("Byte count too large");
+		result[i] = static_cast<uint32_t>(sum);
+	}
+	return result;
+}
+
+
+// Adds the counts of the given bytes to the given array of 256 totals.
+static void countChunk(const uint8_t *data, std::size_t len, uint64_t result[256]) {
+	while (len > 0) {
+		std::size_t n = std::min(len, MAX_SEGMENT_SIZE);
+		uint32_t sub[NUM_SUBHISTOGRAMS][256] = {};
+		std::size_t i = 0;
+		for (; i + NUM_SUBHISTOGRAMS <= n; i += NUM_SUBHISTOGRAMS) {
+			sub[0][data[i + 0]]++;
+			sub[1][data[i + 1]]++;
+			sub[2][data[i + 2]]++;
+			sub[3][data[i + 3]]++;
+		}
+		for (; i < n; i++)
+			sub[0][data[i]]++;
+		for (int j = 0; j < 256; j++) {
+			for (int k = 0; k < NUM_SUBHISTOGRAMS; k++)
+				result[j] += sub[k][j];
+		}
+		data += n;
+		len -= n;
+	}
+}
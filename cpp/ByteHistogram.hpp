@@ -0,0 +1,38 @@
+/* 
+ * Reference arithmetic coding
+ * Copyright (c) Project Nayuki
+ * 
+ * https://www.nayuki.io/page/reference-arithmetic-coding
+ * https://github.com/nayuki/Reference-arithmetic-coding
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+/* 
+ * Counts the occurrences of each byte value in an in-memory buffer, much faster than calling
+ * SimpleFrequencyTable::increment() per byte. Consecutive bytes are counted into separate
+ * sub-histograms, so that runs of the same byte value don't make each increment wait for the
+ * store of the previous one, and a large buffer is split into chunks that are counted on
+ * several threads. The sub-histograms are summed at the end.
+ */
+class ByteHistogram final {
+	
+	/*---- Constants ----*/
+	
+	// Buffers shorter than this are counted on the calling thread, because starting threads would cost more.
+	public: static constexpr std::size_t MIN_PARALLEL_SIZE = 1 << 20;
+	
+	
+	/*---- Methods ----*/
+	
+	// Returns a vector of 256 counts, where element i is the number of bytes with value i in the given
+	// buffer. At most the given number of threads (which must be positive) are used. Throws an exception
+	// if any count exceeds UINT32_MAX.
+	public: static std::vector<std::uint32_t> count(const std::uint8_t *data, std::size_t len, unsigned int threads);
+	
+};
@@ -0,0 +1,69 @@
+/* 
+ * Reference arithmetic coding
+ * Copyright (c) Project Nayuki
+ * 
+ * https://www.nayuki.io/page/reference-arithmetic-coding
+ * https://github.com/nayuki/Reference-arithmetic-coding
+ */
+
+#include <stdexcept>
+#include "Checkpoint.hpp"
+
+using std::uint8_t;
+using std::uint64_t;
+
+
+CheckpointWriter::CheckpointWriter() {
+	write(FORMAT_VERSION);
+}
+
+
+void CheckpointWriter::write(uint64_t value) {
+	while (value >= 0x80) {
+		data.push_back(static_cast<uint8_t>((value & 0x7F) | 0x80));
+		value >>= 7;
+	}
+	data.push_back(static_cast<uint8_t>(value));
+}
+
+
+const std::vector<uint8_t> &CheckpointWriter::getData() const {
+	return data;
+}
+
+
+CheckpointReader::CheckpointReader(const std::vector<uint8_t> &blob) :
+		data(blob),
+		position(0) {
+	if (read() != CheckpointWriter::FORMAT_VERSION)
+		throw std::runtime_error("Unsupported checkpoint version");
+}
+
+
+uint64_t CheckpointReader::read() {
+	uint64_t result = 0;
+	for (int shift = 0; ; shift += 7) {
+		if (position >= data.size())
+			throw std::runtime_error("Checkpoint ended early");
+		uint8_t b = data[position];
+		position++;
+		if (shift == 63 && b > 1)
+			throw std::runtime_error("Malformed checkpoint value");
+		result |= static_cast<uint64_t>(b & 0x7F) << shift;
+		if ((b & 0x80) == 0)
+			return result;
+	}
+}
+
+
+uint64_t CheckpointReader::read(uint64_t limit) {
+	uint64_t result = read();
+	if (result > limit)
+		throw std::runtime_error("Checkpoint value out of range");
+	return result;
+}
+
+
+bool CheckpointReader::isAtEnd() const {
+	return position == data.size();
+}
@@ -0,0 +1,89 @@
+/* 
+ * Reference arithmetic coding
+ * Copyright (c) Project Nayuki
+ * 
+ * https://www.nayuki.io/page/reference-arithmetic-coding
+ * https://github.com/nayuki/Reference-arithmetic-coding
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+/* 
+ * Builds a checkpoint, a binary blob of the state of coders and models, so that coding can be stopped and
+ * later resumed exactly where it was (see ArithmeticEncoder::saveState() and the like). The blob starts
+ * with a format version, followed by whatever the objects write, in the order they are saved, which they
+ * must be restored in. Every value is an unsigned integer written in the LEB128 varint format: 7 bits per
+ * byte starting from the least significant, with the top bit set on every byte but the last. So small
+ * values such as most frequencies take one byte, and the blob of a PPM model is roughly proportional to
+ * its number of nonzero frequencies.
+ */
+class CheckpointWriter final {
+	
+	/*---- Constants ----*/
+	
+	// The format version at the start of every checkpoint.
+	public: static constexpr std::uint32_t FORMAT_VERSION = 1;
+	
+	
+	/*---- Fields ----*/
+	
+	private: std::vector<std::uint8_t> data;
+	
+	
+	/*---- Constructor ----*/
+	
+	// Constructs a writer whose blob contains only the format version.
+	public: explicit CheckpointWriter();
+	
+	
+	/*---- Methods ----*/
+	
+	// Appends the given value.
+	public: void write(std::uint64_t value);
+	
+	
+	// Returns the blob written so far.
+	public: const std::vector<std::uint8_t> &getData() const;
+	
+};
+
+
+
+/* 
+ * Reads the values of a checkpoint made by CheckpointWriter, in the order they were written.
+ */
+class CheckpointReader final {
+	
+	/*---- Fields ----*/
+	
+	private: const std::vector<std::uint8_t> &data;
+	
+	private: std::size_t position;
+	
+	
+	/*---- Constructor ----*/
+	
+	// Constructs a reader over the given blob, which must outlive it, and checks its format version.
+	// Throws an exception if the blob has a different version.
+	public: explicit CheckpointReader(const std::vector<std::uint8_t> &blob);
+	
+	
+	/*---- Methods ----*/
+	
+	// Reads and returns the next value. Throws an exception if the blob ends early or the value is malformed.
+	public: std::uint64_t read();
+	
+	
+	// Reads the next value and returns it if it is at most the given limit, otherwise throws an exception.
+	public: std::uint64_t read(std::uint64_t limit);
+	
+	
+	// Returns whether all of the blob has been read.
+	public: bool isAtEnd() const;
+	
+};
@@ -0,0 +1,249 @@
+/* 
+ * Round-trip tests for checkpoints of the coders and the PPM model
+ * 
+ * Usage: CheckpointTest
+ * This compresses random text with PPM of orders -1 to 3, saves a checkpoint of the encoder or decoder
+ * at various points, resumes from it in new objects, and checks that the output is byte for byte the same
+ * as without the checkpoint. The exit status is zero if every test passes.
+ * 
+ * Copyright (c) Project Nayuki
+ * 
+ * https://www.nayuki.io/page/reference-arithmetic-coding
+ * https://github.com/nayuki/Reference-arithmetic-coding
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "ArithmeticCoder.hpp"
+#include "BitIoStream.hpp"
+#include "Checkpoint.hpp"
+#include "PpmModel.hpp"
+
+using std::uint32_t;
+using std::uint64_t;
+using std::vector;
+
+
+static void testEncoderResume();
+static void testDecoderResume();
+static void testModelMismatch();
+static std::string makeText(unsigned int seed, std::size_t length);
+static vector<std::size_t> getCutPoints(std::size_t length);
+static std::string compress(const std::string &text, int order);
+static void encodeRange(PpmModel &model, vector<uint32_t> &history, ArithmeticEncoder &enc, const std::string &text, std::size_t start, std::size_t end);
+static void saveHistory(CheckpointWriter &out, const vector<uint32_t> &history);
+static vector<uint32_t> loadHistory(CheckpointReader &in, int order);
+static void check(bool cond, const std::string &msg);
+
+
+static constexpr int MIN_ORDER = -1;
+static constexpr int MAX_ORDER = 3;
+static constexpr uint32_t SYMBOL_LIMIT = 257;
+static constexpr uint32_t END_SYMBOL = 256;
+
+
+int main() {
+	try {
+		testEncoderResume();
+		testDecoderResume();
+		testModelMismatch();
+		std::cerr << "Test passed" << std::endl;
+		return EXIT_SUCCESS;
+	} catch (const std::exception &e) {
+		std::cerr << "Test failed: " << e.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+}
+
+
+// Encodes up to each cut point, then resumes in a new encoder and model whose output stream holds only
+// the bytes written before the checkpoint, and compares the result with an uninterrupted encoding.
+static void testEncoderResume() {
+	std::string text = makeText(1, 3000);
+	for (int order = MIN_ORDER; order <= MAX_ORDER; order++) {
+		std::string expect = compress(text, order);
+		for (std::size_t cut : getCutPoints(text.size())) {
+			vector<uint8_t> blob;
+			std::string written;
+			{
+				std::ostringstream out;
+				BitOutputStream bout(out);
+				ArithmeticEncoder enc(32, bout);
+				PpmModel model(order, SYMBOL_LIMIT, END_SYMBOL);
+				vector<uint32_t> history;
+				encodeRange(model, history, enc, text, 0, cut);
+				CheckpointWriter cpw;
+				enc.saveState(cpw);
+				model.saveState(cpw);
+				saveHistory(cpw, history);
+				blob = cpw.getData();
+				written = out.str().substr(0, static_cast<std::size_t>(bout.getByteCount()));
+			}
+
+			std::ostringstream out(written, std::ios_base::ate);
+			BitOutputStream bout(out);
+			ArithmeticEncoder enc(32, bout);
+			PpmModel model(order, SYMBOL_LIMIT, END_SYMBOL);
+			CheckpointReader cpr(blob);
+			enc.loadState(cpr);
+			model.loadState(cpr);
+			vector<uint32_t> history = loadHistory(cpr, order);
+			check(cpr.isAtEnd(), "Checkpoint has unread data");
+			encodeRange(model, history, enc, text, cut, text.size());
+			model.encodeSymbol(enc, history, END_SYMBOL);
+			enc.finish();
+			bout.finish();
+			check(out.str() == expect, "Resumed encoder output differs");
+		}
+	}
+}
+
+
+// Decodes up to each cut point, then resumes in a new decoder and model over the same data from
+// the start, and checks that the rest of the text is decoded.
+static void testDecoderResume() {
+	std::string text = makeText(2, 3000);
+	for (int order = MIN_ORDER; order <= MAX_ORDER; order++) {
+		std::string data = compress(text, order);
+		for (std::size_t cut : getCutPoints(text.size())) {
+			vector<uint8_t> blob;
+			{
+				std::istringstream in(data);
+				BitInputStream bin(in);
+				ArithmeticDecoder dec(32, bin);
+				PpmModel model(order, SYMBOL_LIMIT, END_SYMBOL);
+				vector<uint32_t> history;
+				for (std::size_t i = 0; i < cut; i++) {
+					uint32_t symbol = model.decodeSymbol(dec, history);
+					check(symbol == static_cast<unsigned char>(text[i]), "Decoded symbol mismatch");
+					model.incrementContexts(history, symbol);
+					model.pushHistory(history, symbol);
+				}
+				CheckpointWriter cpw;
+				dec.saveState(cpw);
+				model.saveState(cpw);
+				saveHistory(cpw, history);
+				blob = cpw.getData();
+			}
+
+			std::istringstream in(data);
+			BitInputStream bin(in);
+			ArithmeticDecoder dec(32, bin);
+			PpmModel model(order, SYMBOL_LIMIT, END_SYMBOL);
+			CheckpointReader cpr(blob);
+			dec.loadState(cpr);
+			model.loadState(cpr);
+			vector<uint32_t> history = loadHistory(cpr, order);
+			check(cpr.isAtEnd(), "Checkpoint has unread data");
+			std::string rest;
+			while (true) {
+				uint32_t symbol = model.decodeSymbol(dec, history);
+				if (symbol == END_SYMBOL)
+					break;
+				rest.push_back(static_cast<char>(symbol));
+				model.incrementContexts(history, symbol);
+				model.pushHistory(history, symbol);
+			}
+			check(rest == text.substr(cut), "Resumed decoder output differs");
+		}
+	}
+}
+
+
+// A model checkpoint must not load into a model with a different order, symbol limit or end symbol setting.
+static void testModelMismatch() {
+	PpmModel model(2, SYMBOL_LIMIT, END_SYMBOL);
+	CheckpointWriter cpw;
+	model.saveState(cpw);
+	for (int i = 0; i < 4; i++) {
+		PpmModel other(
+			i == 0 ? 1 : i == 1 ? -1 : 2,
+			i == 2 ? SYMBOL_LIMIT + 1 : SYMBOL_LIMIT,
+			END_SYMBOL,
+			i != 3);
+		CheckpointReader cpr(cpw.getData());
+		bool thrown = false;
+		try {
+			other.loadState(cpr);
+		} catch (const std::exception &) {
+			thrown = true;
+		}
+		check(thrown, "Checkpoint loaded into a model with different parameters");
+	}
+}
+
+
+// Returns random text from a small vocabulary of words, so that the higher-order contexts are used.
+static std::string makeText(unsigned int seed, std::size_t length) {
+	static const char *WORDS[] = {"the ", "arithmetic ", "coder ", "model ", "context ", "escape ", "symbol ", "\n"};
+	std::mt19937 random(seed);
+	std::string result;
+	while (result.size() < length) {
+		if (random() % 16 == 0)
+			result.push_back(static_cast<char>(random() % 256));
+		else
+			result += WORDS[random() % (sizeof(WORDS) / sizeof(WORDS[0]))];
+	}
+	result.resize(length);
+	return result;
+}
+
+
+// Returns the points to save a checkpoint at, including before the first symbol and after the last.
+static vector<std::size_t> getCutPoints(std::size_t length) {
+	return vector<std::size_t>{0, 1, 7, length / 3, length / 2 + 5, length - 1, length};
+}
+
+
+// Returns the text compressed without interruption, ending with the end symbol.
+static std::string compress(const std::string &text, int order) {
+	std::ostringstream out;
+	BitOutputStream bout(out);
+	ArithmeticEncoder enc(32, bout);
+	PpmModel model(order, SYMBOL_LIMIT, END_SYMBOL);
+	vector<uint32_t> history;
+	encodeRange(model, history, enc, text, 0, text.size());
+	model.encodeSymbol(enc, history, END_SYMBOL);
+	enc.finish();
+	bout.finish();
+	return out.str();
+}
+
+
+static void encodeRange(PpmModel &model, vector<uint32_t> &history, ArithmeticEncoder &enc, const std::string &text, std::size_t start, std::size_t end) {
+	for (std::size_t i = start; i < end; i++) {
+		uint32_t symbol = static_cast<unsigned char>(text[i]);
+		model.encodeSymbol(enc, history, symbol);
+		model.incrementContexts(history, symbol);
+		model.pushHistory(history, symbol);
+	}
+}
+
+
+static void saveHistory(CheckpointWriter &out, const vector<uint32_t> &history) {
+	out.write(history.size());
+	for (uint32_t symbol : history)
+		out.write(symbol);
+}
+
+
+static vector<uint32_t> loadHistory(CheckpointReader &in, int order) {
+	vector<uint32_t> result;
+	uint64_t size = in.read(order >= 1 ? static_cast<uint64_t>(order) : 0);
+	for (uint64_t i = 0; i < size; i++)
+		result.push_back(static_cast<uint32_t>(in.read(END_SYMBOL - 1)));
+	return result;
+}
+
+
+static void check(bool cond, const std::string &msg) {
+	if (!cond)
+		throw std::logic_error(msg);
+}
@@ -0,0 +1,75 @@
+/* 
+ * Reference arithmetic coding
+ * Copyright (c) Project Nayuki
+ * 
+ * https://www.nayuki.io/page/reference-arithmetic-coding
+ * https://github.com/nayuki/Reference-arithmetic-coding
+ */
+
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+#include "CodingCostMeter.hpp"
+
+using std::uint32_t;
+using std::uint64_t;
+
+
+CodingCostMeter::CodingCostMeter() :
+	currentOrder(0),
+	currentKind(SYMBOL) {}
+
+
+void CodingCostMeter::setCategory(int order, Kind kind) {
+	if (order < -1 || kind < 0 || kind >= NUM_KINDS)
+		throw std::domain_error("Invalid category");
+	currentOrder = order;
+	currentKind = kind;
+}
+
+
+void CodingCostMeter::record(const FrequencyTable &freqs, uint32_t symbol, uint64_t oldRange, uint64_t newRange) {
+	if (newRange == 0 || newRange > oldRange)
+		throw std::invalid_argument("Invalid range");
+	record(std::log2(static_cast<double>(freqs.getTotal())) - std::log2(static_cast<double>(freqs.get(symbol))),
+		std::log2(static_cast<double>(oldRange)) - std::log2(static_cast<double>(newRange)));
+}
+
+
+void CodingCostMeter::record(double idealBits, double codedBits) {
+	std::size_t index = static_cast<std::size_t>(currentOrder + 1) * NUM_KINDS + currentKind;
+	if (index >= entries.size())
+		entries.resize(index + 1, Entry{0, 0, 0});
+	Entry &entry = entries.at(index);
+	entry.count++;
+	entry.idealBits += idealBits;
+	entry.codedBits += codedBits;
+}
+
+
+int CodingCostMeter::getHighestOrder() const {
+	for (std::size_t i = entries.size(); i > 0; i--) {
+		if (entries.at(i - 1).count > 0)
+			return static_cast<int>((i - 1) / NUM_KINDS) - 1;
+	}
+	return -2;
+}
+
+
+CodingCostMeter::Entry CodingCostMeter::get(int order, Kind kind) const {
+	if (order < -1 || kind < 0 || kind >= NUM_KINDS)
+		throw std::domain_error("Invalid category");
+	std::size_t index = static_cast<std::size_t>(order + 1) * NUM_KINDS + kind;
+	return index < entries.size() ? entries.at(index) : Entry{0, 0, 0};
+}
+
+
+CodingCostMeter::Entry CodingCostMeter::getTotal() const {
+	Entry result{0, 0, 0};
+	for (const Entry &entry : entries) {
+		result.count += entry.count;
+		result.idealBits += entry.idealBits;
+		result.codedBits += entry.codedBits;
+	}
+	return result;
+}
@@ -0,0 +1,88 @@
+/* 
+ * Reference arithmetic coding
+ * Copyright (c) Project Nayuki
+ * 
+ * https://www.nayuki.io/page/reference-arithmetic-coding
+ * https://github.com/nayuki/Reference-arithmetic-coding
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "FrequencyTable.hpp"
+
+
+/* 
+ * Accumulates, for every symbol that an ArithmeticEncoder codes, the ideal cost -log2(freq/total)
+ * according to the frequency table used, and the cost that the coder actually incurred, which is
+ * log2 of the factor by which the symbol narrowed the coder's integer range. The difference between
+ * the two is the loss due to the coder's finite precision (numStateBits and the table total). The
+ * costs are broken down by category - a model order and a symbol kind - which the user of the encoder
+ * sets before coding each symbol; PpmModel does so automatically. The cost of ending the stream is not
+ * a per-symbol cost and is not included; compare the totals with the actual output length for that.
+ */
+class CodingCostMeter final {
+	
+	/*---- Helper types ----*/
+	
+	public: enum Kind {
+		SYMBOL,       // An ordinary data symbol
+		ESCAPE,       // A PPM escape to a lower order context
+		END_OF_DATA,  // The symbol that marks the end of the data
+		NUM_KINDS,
+	};
+	
+	
+	public: struct Entry final {
+		std::uint64_t count;
+		double idealBits;
+		double codedBits;
+	};
+	
+	
+	
+	/*---- Fields ----*/
+	
+	// Indexed by (order + 1) * NUM_KINDS + kind.
+	private: std::vector<Entry> entries;
+	
+	private: int currentOrder;
+	
+	private: Kind currentKind;
+	
+	
+	/*---- Constructor ----*/
+	
+	// Constructs a meter with all costs zero and the category set to order 0 and SYMBOL.
+	public: explicit CodingCostMeter();
+	
+	
+	/*---- Methods ----*/
+	
+	// Sets the category that subsequent symbols are counted in. The order must be at least -1.
+	public: void setCategory(int order, Kind kind);
+	
+	
+	// Counts one symbol coded with the given frequency table in the current category, where
+	// the coder's range was narrowed from the given old size to the given new size.
+	public: void record(const FrequencyTable &freqs, std::uint32_t symbol, std::uint64_t oldRange, std::uint64_t newRange);
+	
+	
+	// Counts one symbol with the given ideal and actual costs in the current category, for symbols
+	// that are not coded with a frequency table, such as binary decisions and runs of equiprobable bits.
+	public: void record(double idealBits, double codedBits);
+	
+	
+	// Returns the highest order that has any symbols counted, or -2 if nothing was counted.
+	public: int getHighestOrder() const;
+	
+	
+	// Returns the totals for the given category, which are all zero if nothing was counted in it.
+	public: Entry get(int order, Kind kind) const;
+	
+	
+	// Returns the totals over all categories.
+	public: Entry getTotal() const;
+	
+};
@@ -0,0 +1,158 @@
+/* 
+ * Coding efficiency report for the arithmetic coder and models
+ * 
+ * Usage: CodingEfficiency [--model=static|adaptive|ppm] [--order=N] [--state-bits=N] InputFile
+ * This compresses the input file in memory the same way as ArithmeticCompress, AdaptiveArithmeticCompress,
+ * or PpmCompress (the default, with --order defaulting to 3) and prints how many bits each part of the
+ * coding cost. For each category of coded symbol, the "ideal" column is the sum of -log2(freq/total) over
+ * the frequency tables used, and the "coded" column is what the arithmetic coder actually spent, so their
+ * difference is the precision loss of the coder. With the PPM model, the categories are broken down by
+ * context order and into data symbols, escapes, and the end-of-data marker. The actual output length is
+ * also shown, whose excess over the coded total is the frequency table header (for the static model)
+ * plus the termination and padding at the end of the stream. The coder state size can be set with
+ * --state-bits (default 32, as the compression applications use) to see its effect on precision.
+ * For comparison, the size that CostEstimator predicts without coding anything is shown last.
+ * 
+ * Copyright (c) Project Nayuki
+ * 
+ * https://www.nayuki.io/page/reference-arithmetic-coding
+ * https://github.com/nayuki/Reference-arithmetic-coding
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "ArithmeticCoder.hpp"
+#include "BitIoStream.hpp"
+#include "ByteHistogram.hpp"
+#include "CodingCostMeter.hpp"
+#include "CommandLine.hpp"
+#include "CostEstimator.hpp"
+#include "FileStream.hpp"
+#include "FrequencyHeader.hpp"
+#include "FrequencyTable.hpp"
+#include "PpmModel.hpp"
+
+using std::uint8_t;
+using std::uint32_t;
+using std::vector;
+
+
+static void printRow(const std::string &name, const CodingCostMeter::Entry &entry);
+
+
+int main(int argc, char *argv[]) {
+	// Handle command line arguments
+	CommandLine cmd(argc, argv);
+	const vector<std::string> &args = cmd.getArguments();
+	if (args.size() != 1 || !cmd.hasOnlyOptions({"model", "order", "state-bits"})) {
+		std::cerr << "Usage: " << argv[0] << " [--model=static|adaptive|ppm] [--order=N] [--state-bits=N] InputFile" << std::endl;
+		return EXIT_FAILURE;
+	}
+	
+	try {
+		std::string model = cmd.getString("model", "ppm");
+		if (model != "static" && model != "adaptive" && model != "ppm")
+			throw std::invalid_argument("Unknown model: " + model);
+		int order = static_cast<int>(cmd.getNumber("order", 3));
+		int stateBits = static_cast<int>(cmd.getNumber("state-bits", 32));
+		if (model != "ppm" && cmd.hasOption("order"))
+			throw std::invalid_argument("--order only applies to the PPM model");
+		
+		InputFileStream in(args.at(0).c_str());
+		vector<uint8_t> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+		
+		// Compress with the meter attached, like the corresponding application does
+		std::ostringstream out;
+		BitOutputStream bout(out);
+		CodingCostMeter meter;
+		long headerBits = 0;
+		if (model == "static") {
+			vector<uint32_t> normalized = FrequencyHeader::normalize(ByteHistogram::count(data.data(), data.size(), 1));
+			FrequencyHeader::write(normalized, bout);
+			headerBits = FrequencyHeader::getBitLength(normalized);
+			SimpleFrequencyTable freqs(normalized);
+			ArithmeticEncoder enc(stateBits, bout);
+			enc.setCostMeter(&meter);
+			for (uint8_t b : data)
+				enc.write(freqs, b);
+			meter.setCategory(0, CodingCostMeter::END_OF_DATA);
+			enc.write(freqs, 256);  // EOF
+			enc.finish();
+			
+		} else if (model == "adaptive") {
+			SimpleFrequencyTable freqs(FlatFrequencyTable(257));
+			ArithmeticEncoder enc(stateBits, bout);
+			enc.setCostMeter(&meter);
+			for (uint8_t b : data) {
+				enc.write(freqs, b);
+				freqs.increment(b);
+			}
+			meter.setCategory(0, CodingCostMeter::END_OF_DATA);
+			enc.write(freqs, 256);  // EOF
+			enc.finish();
+			
+		} else {
+			PpmModel ppm(order, 257, 256);
+			ArithmeticEncoder enc(stateBits, bout);
+			enc.setCostMeter(&meter);
+			vector<uint32_t> history;
+			for (uint8_t b : data) {
+				ppm.encodeSymbol(enc, history, b);
+				ppm.incrementContexts(history, b);
+				ppm.pushHistory(history, b);
+			}
+			ppm.encodeSymbol(enc, history, 256);  // EOF
+			enc.finish();
+		}
+		bout.finish();
+		long outputBits = static_cast<long>(out.str().size()) * 8;
+		
+		// Print the report
+		std::printf("Model: %s", model.c_str());
+		if (model == "ppm")
+			std::printf(" (order %d)", order);
+		std::printf(", state bits: %d\n", stateBits);
+		std::printf("Input: %zu bytes\n\n", data.size());
+		std::printf("%-24s %12s %16s %16s %12s %8s\n", "Category", "Symbols", "Ideal bits", "Coded bits", "Loss bits", "Loss");
+		static const char *KIND_NAMES[] = {"symbols", "escapes", "end"};
+		for (int ord = meter.getHighestOrder(); ord >= -1; ord--) {
+			for (int kind = 0; kind < CodingCostMeter::NUM_KINDS; kind++) {
+				CodingCostMeter::Entry entry = meter.get(ord, static_cast<CodingCostMeter::Kind>(kind));
+				if (entry.count > 0)
+					printRow("Order " + std::to_string(ord) + " " + KIND_NAMES[kind], entry);
+			}
+		}
+		CodingCostMeter::Entry total = meter.getTotal();
+		printRow("Total", total);
+		std::printf("\n");
+		std::printf("Output: %ld bits (%ld bytes)\n", outputBits, outputBits / 8);
+		if (headerBits > 0)
+			std::printf("Frequency table header: %ld bits\n", headerBits);
+		std::printf("Termination and padding: %.1f bits\n", outputBits - headerBits - total.codedBits);
+		BlockModel blockModel = model == "static" ? BlockModel::STATIC : (model == "adaptive" ? BlockModel::ADAPTIVE : BlockModel::PPM);
+		std::printf("Estimate without coding (CostEstimator): %.1f bits\n", CostEstimator::estimate(blockModel, order, data.data(), data.size()));
+		if (!data.empty())
+			std::printf("Ideal: %.4f bits/byte, output: %.4f bits/byte\n", total.idealBits / data.size(), static_cast<double>(outputBits) / data.size());
+		return EXIT_SUCCESS;
+		
+	} catch (const std::exception &e) {
+		std::cout << std::flush;
+		std::cerr << e.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+}
+
+
+static void printRow(const std::string &name, const CodingCostMeter::Entry &entry) {
+	double loss = entry.codedBits - entry.idealBits;
+	std::printf("%-24s %12llu %16.1f %16.1f %12.3f %7.4f%%\n", name.c_str(), static_cast<unsigned long long>(entry.count),
+		entry.idealBits, entry.codedBits, loss, entry.idealBits > 0 ? loss / entry.idealBits * 100 : 0.0);
+}
@@ -0,0 +1,49 @@
+/* 
+ * Reference arithmetic coding
+ * Copyright (c) Project Nayuki
+ * 
+ * https://www.nayuki.io/page/reference-arithmetic-coding
+ * https://github.com/nayuki/Reference-arithmetic-coding
+ */
+
+#include <stdexcept>
+#include "CodingStats.hpp"
+
+using std::uint64_t;
+
+
+std::atomic<uint64_t> CodingStats::counters[NUM_COUNTERS];
+
+
+uint64_t CodingStats::get(Counter counter) {
+	if (counter < 0 || counter >= NUM_COUNTERS)
+		throw std::domain_error("Invalid counter");
+	return counters[counter].load(std::memory_order_relaxed);
+}
+
+
+void CodingStats::reset() {
+	for (std::atomic<uint64_t> &counter : counters)
+		counter.store(0, std::memory_order_relaxed);
+}
+
+
+void CodingStats::dump(std::ostream &out) {
+	if (!ENABLED) {
+		out << "Coding statistics are not available in this build (rebuild with \"make clean && make STATS=1\")" << std::endl;
+		return;
+	}
+	out << "Symbols coded: " << get(SYMBOLS_CODED) << std::endl;
+	out << "Bits shifted: " << get(BITS_SHIFTED) << std::endl;
+	out << "Underflows: " << get(UNDERFLOWS) << std::endl;
+	out << "Max pending underflows: " << get(MAX_PENDING_UNDERFLOWS) << std::endl;
+	if (get(DECODER_SEARCH_STEPS) > 0)
+		out << "Decoder search steps: " << get(DECODER_SEARCH_STEPS) << std::endl;
+	if (get(CONTEXTS_CREATED) > 0)
+		out << "Contexts created: " << get(CONTEXTS_CREATED) << std::endl;
+	for (int order = 0; order <= MAX_ESCAPE_ORDER; order++) {
+		uint64_t count = get(static_cast<Counter>(ESCAPES + order));
+		if (count > 0)
+			out << "Escapes from order " << order << (order == MAX_ESCAPE_ORDER ? "+" : "") << ": " << count << std::endl;
+	}
+}
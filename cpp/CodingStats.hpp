@@ -0,0 +1,97 @@
+/* 
+ * Reference arithmetic coding
+ * Copyright (c) Project Nayuki
+ * 
+ * https://www.nayuki.io/page/reference-arithmetic-coding
+ * https://github.com/nayuki/Reference-arithmetic-coding
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+
+
+/* 
+ * Process-wide event counters for the arithmetic coder and the PPM model, for finding out
+ * how a particular input is being coded. The counters only exist when the code is compiled
+ * with the macro CODING_STATS defined (e.g. "make clean && make STATS=1"); otherwise the
+ * CODING_STATS_* macros expand to nothing, so the instrumentation costs nothing at all.
+ * The counters are atomic, so the totals are correct when several threads code at once.
+ */
+class CodingStats final {
+	
+	/*---- Constants ----*/
+	
+	// Escapes from PPM contexts of this order or higher are counted together.
+	public: static constexpr int MAX_ESCAPE_ORDER = 15;
+	
+	
+	public: enum Counter {
+		SYMBOLS_CODED,           // Symbols (including escapes) coded by ArithmeticEncoder or ArithmeticDecoder
+		BITS_SHIFTED,            // Calls to shift(), i.e. code bits settled
+		UNDERFLOWS,              // Calls to underflow()
+		MAX_PENDING_UNDERFLOWS,  // Largest value of ArithmeticEncoder's numUnderflow
+		DECODER_SEARCH_STEPS,    // Iterations of the symbol search in ArithmeticDecoder::read()
+		CONTEXTS_CREATED,        // PPM context nodes created by PpmModel::incrementContexts()
+		ESCAPES,                 // PPM escapes from order 0; the following counters are for orders 1, 2, etc.
+		NUM_COUNTERS = ESCAPES + MAX_ESCAPE_ORDER + 1,
+	};
+	
+	
+	// Whether this build was compiled with the counters enabled.
+	#if defined(CODING_STATS)
+		public: static constexpr bool ENABLED = true;
+	#else
+		public: static constexpr bool ENABLED = false;
+	#endif
+	
+	
+	/*---- Fields ----*/
+	
+	private: static std::atomic<std::uint64_t> counters[NUM_COUNTERS];
+	
+	
+	/*---- Methods ----*/
+	
+	public: static void add(Counter counter, std::uint64_t delta) {
+		counters[counter].fetch_add(delta, std::memory_order_relaxed);
+	}
+	
+	
+	// Raises the given counter to the given value if it is currently lower.
+	public: static void max(Counter counter, std::uint64_t value) {
+		std::uint64_t current = counters[counter].load(std::memory_order_relaxed);
+		while (current < value && !counters[counter].compare_exchange_weak(current, value, std::memory_order_relaxed));
+	}
+	
+	
+	public: static void addEscape(int order) {
+		add(static_cast<Counter>(ESCAPES + (order < MAX_ESCAPE_ORDER ? order : MAX_ESCAPE_ORDER)), 1);
+	}
+	
+	
+	public: static std::uint64_t get(Counter counter);
+	
+	
+	// Sets all counters to zero.
+	public: static void reset();
+	
+	
+	// Writes a human-readable listing of the non-zero counters to the given stream,
+	// or a note saying how to enable the counters if this build doesn't have them.
+	public: static void dump(std::ostream &out);
+	
+};
+
+
+#if defined(CODING_STATS)
+	#define CODING_STATS_ADD(counter, delta)  CodingStats::add(CodingStats::counter, (delta))
+	#define CODING_STATS_MAX(counter, value)  CodingStats::max(CodingStats::counter, (value))
+	#define CODING_STATS_ESCAPE(order)  CodingStats::addEscape(order)
+#else
+	#define CODING_STATS_ADD(counter, delta)  ((void)0)
+	#define CODING_STATS_MAX(counter, value)  ((void)0)
+	#define CODING_STATS_ESCAPE(order)  ((void)0)
+#endif
@@ -0,0 +1,92 @@
+/* 
+ * Reference arithmetic coding
+ * Copyright (c) Project Nayuki
+ * 
+ * https://www.nayuki.io/page/reference-arithmetic-coding
+ * https://github.com/nayuki/Reference-arithmetic-coding
+ */
+
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
+#include "CommandLine.hpp"
+
+using std::string;
+
+
+CommandLine::CommandLine(int argc, char *argv[]) {
+	bool optionsEnded = false;
+	for (int i = 1; i < argc; i++) {
+		string arg(argv[i]);
+		if (optionsEnded || arg.compare(0, 2, "--") != 0)
+			arguments.push_back(arg);
+		else if (arg == "--")
+			optionsEnded = true;
+		else {
+			std::size_t equals = arg.find('=');
+			if (equals == string::npos)
+				options[arg.substr(2)] = "";
+			else
+				options[arg.substr(2, equals - 2)] = arg.substr(equals + 1);
+		}
+	}
+}
+
+
+const std::vector<string> &CommandLine::getArguments() const {
+	return arguments;
+}
+
+
+bool CommandLine::hasOnlyOptions(std::initializer_list<const char *> names) const {
+	for (const auto &entry : options) {
+		bool found = false;
+		for (const char *name : names)
+			found |= entry.first == name;
+		if (!found)
+			return false;
+	}
+	return true;
+}
+
+
+bool CommandLine::hasOption(const string &name) const {
+	return options.find(name) != options.end();
+}
+
+
+unsigned long CommandLine::getNumber(const string &name, unsigned long defaultValue) const {
+	auto it = options.find(name);
+	if (it == options.end())
+		return defaultValue;
+	const string &value = it->second;
+	unsigned long multiplier = 1;
+	std::size_t digits = value.size();
+	if (digits > 0 && (value.back() == 'k' || value.back() == 'K')) {
+		multiplier = 1UL << 10;
+		digits--;
+	} else if (digits > 0 && (value.back() == 'm' || value.back() == 'M')) {
+		multiplier = 1UL << 20;
+		digits--;
+	}
+	if (digits == 0)
+		throw std::invalid_argument("Missing number for option --" + name);
+	unsigned long result = 0;
+	for (std::size_t i = 0; i < digits; i++) {
+		char c = value[i];
+		if (c < '0' || c > '9')
+			throw std::invalid_argument("Invalid number for option --" + name);
+		if (result > (std::numeric_limits<unsigned long>::max() - (c - '0')) / 10)
+			throw std::out_of_range("Number too large for option --" + name);
+		result = result * 10 + static_cast<unsigned long>(c - '0');
+	}
+	if (result > std::numeric_limits<unsigned long>::max() / multiplier)
+		throw std::out_of_range("Number too large for option --" + name);
+	return result * multiplier;
+}
+
+
+string CommandLine::getString(const string &name, const string &defaultValue) const {
+	auto it = options.find(name);
+	return it != options.end() ? it->second : defaultValue;
+}
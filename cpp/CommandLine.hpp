@@ -0,0 +1,62 @@
+/* 
+ * Reference arithmetic coding
+ * Copyright (c) Project Nayuki
+ * 
+ * https://www.nayuki.io/page/reference-arithmetic-coding
+ * https://github.com/nayuki/Reference-arithmetic-coding
+ */
+
+#pragma once
+
+#include <initializer_list>
+#include <map>
+#include <string>
+#include <vector>
+
+
+/* 
+ * The arguments of a command-line application, split into options and positional arguments.
+ * An option has the form "--name" or "--name=value". A lone "-" is a positional argument
+ * (conventionally meaning standard input or output), and "--" ends the list of options.
+ */
+class CommandLine final {
+	
+	/*---- Fields ----*/
+	
+	// Maps each option name (without the leading dashes) to its value, which is empty if none was given.
+	private: std::map<std::string,std::string> options;
+	
+	// The positional arguments in order.
+	private: std::vector<std::string> arguments;
+	
+	
+	/*---- Constructor ----*/
+	
+	// Parses the given arguments, skipping the program name in argv[0].
+	public: explicit CommandLine(int argc, char *argv[]);
+	
+	
+	/*---- Methods ----*/
+	
+	// Returns the positional arguments.
+	public: const std::vector<std::string> &getArguments() const;
+	
+	
+	// Returns whether every option that was given has one of the given names.
+	public: bool hasOnlyOptions(std::initializer_list<const char *> names) const;
+	
+	
+	// Returns whether the option with the given name was given.
+	public: bool hasOption(const std::string &name) const;
+	
+	
+	// Returns the value of the given option as a non-negative integer, or the default value if the option
+	// is absent. A value may have the suffix "k" or "m" for multiples of 1024 or 1048576. Throws an
+	// exception if the value is malformed.
+	public: unsigned long getNumber(const std::string &name, unsigned long defaultValue) const;
+	
+	
+	// Returns the value of the given option, or the default value if the option is absent.
+	public: std::string getString(const std::string &name, const std::string &defaultValue) const;
+	
+};
@@ -0,0 +1,321 @@
+/* 
+ * End-to-end benchmark of the compression applications on generated corpora
+ * 
+ * Usage: CorpusBenchmark [--size=N] [--seed=N] [--blocks] [--tool-dir=Dir] [OutputFile]
+ * This generates several synthetic corpora of N bytes each (default 256 KiB) - text-like, log-like,
+ * random, runs, and binary tables - and runs every compressor/decompressor pair on each one as a
+ * separate process. For every run it reports the compression ratio (compressed size divided by
+ * original size), the throughput of each direction in MB/s (10^6 bytes of original data per second),
+ * the peak resident set size of each process, and whether the round trip reproduced the input exactly.
+ * With --blocks, every pair is additionally run in its block container mode. The report is a JSON
+ * document written to the output file, or to standard output if none is given. The applications are
+ * looked for in the given directory, by default the directory containing this program. The exit status
+ * is nonzero if any run fails or doesn't round-trip. Build with "make bench". This program uses POSIX
+ * process and resource usage functions, and the corpora are written to a temporary directory.
+ * 
+ * Copyright (c) Project Nayuki
+ * 
+ * https://www.nayuki.io/page/reference-arithmetic-coding
+ * https://github.com/nayuki/Reference-arithmetic-coding
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include <sys/resource.h>
+#include <sys/time.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "CommandLine.hpp"
+#include "FileStream.hpp"
+
+using std::string;
+using std::uint32_t;
+using std::vector;
+
+
+struct Corpus final {
+	string name;
+	vector<char> data;
+};
+
+
+// The result of running one application as a child process.
+struct ProcessResult final {
+	bool succeeded;
+	double seconds;
+	long peakRssKib;
+};
+
+
+static const char *TOOL_PAIRS[][2] = {
+	{"ArithmeticCompress", "ArithmeticDecompress"},
+	{"AdaptiveArithmeticCompress", "AdaptiveArithmeticDecompress"},
+	{"PpmCompress", "PpmDecompress"},
+};
+
+
+static vector<Corpus> makeCorpora(std::size_t size, uint32_t seed);
+static ProcessResult runProcess(const vector<string> &args);
+static void writeFile(const string &path, const vector<char> &data);
+static vector<char> readFile(const string &path);
+static string formatNumber(double x);
+
+
+int main(int argc, char *argv[]) {
+	// Handle command line arguments
+	CommandLine cmd(argc, argv);
+	const vector<string> &args = cmd.getArguments();
+	if (args.size() > 1 || !cmd.hasOnlyOptions({"size", "seed", "blocks", "tool-dir"})) {
+		std::cerr << "Usage: " << argv[0] << " [--size=N] [--seed=N] [--blocks] [--tool-dir=Dir] [OutputFile]" << std::endl;
+		return EXIT_FAILURE;
+	}
+	
+	string tempDir;
+	try {
+		std::size_t size = cmd.getNumber("size", 1UL << 18);
+		uint32_t seed = static_cast<uint32_t>(cmd.getNumber("seed", 1));
+		string self(argv[0]);
+		std::size_t slash = self.rfind('/');
+		string toolDir = cmd.getString("tool-dir", slash == string::npos ? "." : self.substr(0, slash));
+		vector<bool> modes{false};
+		if (cmd.hasOption("blocks"))
+			modes.push_back(true);
+		
+		char dirTemplate[] = "/tmp/CorpusBenchmark-XXXXXX";
+		if (mkdtemp(dirTemplate) == nullptr)
+			throw std::runtime_error("Cannot create temporary directory");
+		tempDir = dirTemplate;
+		string inputPath = tempDir + "/input";
+		string compressedPath = tempDir + "/compressed";
+		string decompressedPath = tempDir + "/decompressed";
+		
+		bool allPassed = true;
+		std::ostringstream json;
+		json << "{\n\t\"size\": " << size << ",\n\t\"seed\": " << seed << ",\n\t\"results\": [";
+		bool first = true;
+		for (const Corpus &corpus : makeCorpora(size, seed)) {
+			writeFile(inputPath, corpus.data);
+			for (const auto &pair : TOOL_PAIRS) {
+				for (bool blocks : modes) {
+					vector<string> compArgs{toolDir + "/" + pair[0]};
+					vector<string> decompArgs{toolDir + "/" + pair[1]};
+					if (blocks) {
+						compArgs.push_back("--blocks");
+						decompArgs.push_back("--blocks");
+					}
+					compArgs.insert(compArgs.end(), {inputPath, compressedPath});
+					decompArgs.insert(decompArgs.end(), {compressedPath, decompressedPath});
+					std::cerr << corpus.name << ": " << pair[0] << (blocks ? " --blocks" : "") << std::endl;
+					
+					std::remove(compressedPath.c_str());
+					std::remove(decompressedPath.c_str());
+					ProcessResult comp = runProcess(compArgs);
+					ProcessResult decomp = comp.succeeded ? runProcess(decompArgs) : ProcessResult{false, 0, 0};
+					std::size_t compressedSize = comp.succeeded ? readFile(compressedPath).size() : 0;
+					bool roundTrip = decomp.succeeded && readFile(decompressedPath) == corpus.data;
+					allPassed &= roundTrip;
+					
+					double megabytes = corpus.data.size() / 1.0e6;
+					json << (first ? "" : ",") << "\n\t\t{";
+					json << "\"corpus\": \"" << corpus.name << "\", ";
+					json << "\"compressor\": \"" << pair[0] << "\", ";
+					json << "\"decompressor\": \"" << pair[1] << "\", ";
+					json << "\"mode\": \"" << (blocks ? "blocks" : "raw") << "\", ";
+					json << "\"original_bytes\": " << corpus.data.size() << ", ";
+					json << "\"compressed_bytes\": " << compressedSize << ", ";
+					json << "\"ratio\": " << formatNumber(static_cast<double>(compressedSize) / corpus.data.size()) << ", ";
+					json << "\"compress_mb_per_s\": " << formatNumber(megabytes / comp.seconds) << ", ";
+					json << "\"decompress_mb_per_s\": " << formatNumber(megabytes / decomp.seconds) << ", ";
+					json << "\"compress_peak_rss_kib\": " << comp.peakRssKib << ", ";
+					json << "\"decompress_peak_rss_kib\": " << decomp.peakRssKib << ", ";
+					json << "\"round_trip\": " << (roundTrip ? "true" : "false") << "}";
+					first = false;
+				}
+			}
+		}
+		json << "\n\t]\n}\n";
+		
+		std::remove(inputPath.c_str());
+		std::remove(compressedPath.c_str());
+		std::remove(decompressedPath.c_str());
+		rmdir(tempDir.c_str());
+		tempDir.clear();
+		
+		string outputFile = args.empty() ? "-" : args.at(0);
+		OutputFileStream out(outputFile.c_str());
+		out << json.str();
+		out.finish();
+		return allPassed ? EXIT_SUCCESS : EXIT_FAILURE;
+		
+	} catch (const std::exception &e) {
+		if (!tempDir.empty()) {
+			for (const char *name : {"/input", "/compressed", "/decompressed"})
+				std::remove((tempDir + name).c_str());
+			rmdir(tempDir.c_str());
+		}
+		std::cerr << e.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+}
+
+
+// Returns the corpora, each exactly the given size, generated deterministically from the given seed.
+// Only std::mt19937 is used for randomness, because the standard library's distribution
+// classes are not guaranteed to give the same values everywhere.
+static vector<Corpus> makeCorpora(std::size_t size, uint32_t seed) {
+	std::mt19937 rand(seed);
+	vector<Corpus> result;
+	
+	// Words from a small vocabulary, where earlier words are more common, in sentences and lines
+	static const char *WORDS[] = {
+		"the", "of", "and", "to", "a", "in", "is", "that", "for", "it", "as", "was", "with", "be", "by",
+		"on", "not", "he", "this", "are", "or", "his", "from", "at", "which", "but", "have", "an", "had",
+		"they", "you", "were", "their", "one", "all", "we", "can", "her", "has", "there", "been", "if",
+		"more", "when", "will", "would", "who", "so", "no", "arithmetic", "coding", "symbol", "frequency",
+		"table", "model", "context", "probability", "interval", "encoder", "decoder", "stream", "bits",
+	};
+	const uint32_t numWords = sizeof(WORDS) / sizeof(WORDS[0]);
+	string text;
+	bool sentenceStart = true;
+	while (text.size() < size) {
+		// The minimum of two uniform choices favors low indexes
+		uint32_t index = std::min(rand() % numWords, rand() % numWords);
+		string word(WORDS[index]);
+		if (sentenceStart)
+			word.at(0) = static_cast<char>(word.at(0) - 'a' + 'A');
+		text += word;
+		sentenceStart = rand() % 12 == 0;
+		if (sentenceStart)
+			text += rand() % 4 == 0 ? ".\n" : ". ";
+		else
+			text += rand() % 10 == 0 ? ", " : " ";
+	}
+	result.push_back(Corpus{"text", vector<char>(text.begin(), text.begin() + size)});
+	
+	// Server log lines with increasing timestamps and a few varying fields
+	static const char *LEVELS[] = {"INFO", "INFO", "INFO", "DEBUG", "WARN", "ERROR"};
+	static const char *PATHS[] = {"/index.html", "/api/v1/items", "/api/v1/users", "/static/app.js", "/health"};
+	string log;
+	unsigned long millis = 0;
+	while (log.size() < size) {
+		millis += rand() % 2000;
+		// Each random value is drawn in its own statement because argument evaluation order is unspecified
+		const char *level = LEVELS[rand() % 6];
+		unsigned int worker = static_cast<unsigned int>(rand() % 8);
+		const char *path = PATHS[rand() % 5];
+		unsigned int status = rand() % 10 == 0 ? 404 : 200;
+		unsigned int bytes = static_cast<unsigned int>(rand() % 50000);
+		unsigned int time = static_cast<unsigned int>(rand() % 300);
+		char line[200];
+		std::snprintf(line, sizeof(line), "2024-01-%02lu %02lu:%02lu:%02lu.%03lu %-5s [worker-%u] GET %s status=%u bytes=%u time=%ums\n",
+			1 + millis / 86400000 % 28, millis / 3600000 % 24, millis / 60000 % 60, millis / 1000 % 60, millis % 1000,
+			level, worker, path, status, bytes, time);
+		log += line;
+	}
+	result.push_back(Corpus{"log", vector<char>(log.begin(), log.begin() + size)});
+	
+	// Uniformly random bytes, which are incompressible
+	Corpus random{"random", vector<char>()};
+	for (std::size_t i = 0; i < size; i++)
+		random.data.push_back(static_cast<char>(rand()));
+	result.push_back(std::move(random));
+	
+	// Runs of a repeated byte with random lengths in [1, 64], drawn from a small set of byte values
+	Corpus runs{"runs", vector<char>()};
+	while (runs.data.size() < size) {
+		char b = static_cast<char>(rand() % 16 * 16);
+		for (uint32_t n = rand() % 64 + 1; n > 0 && runs.data.size() < size; n--)
+			runs.data.push_back(b);
+	}
+	result.push_back(std::move(runs));
+	
+	// An array of 16-byte little-endian records: a sequential 32-bit ID, a 32-bit timestamp
+	// with small increments, a 16-bit category, a 16-bit small signed value, and a 32-bit price
+	Corpus binary{"binary", vector<char>()};
+	auto append = [&binary](uint32_t value, int numBytes) {
+		for (int i = 0; i < numBytes; i++)
+			binary.data.push_back(static_cast<char>(value >> (i * 8)));
+	};
+	uint32_t timestamp = 1700000000;
+	for (uint32_t id = 0; binary.data.size() < size; id++) {
+		timestamp += static_cast<uint32_t>(rand() % 60);
+		append(id, 4);
+		append(timestamp, 4);
+		append(static_cast<uint32_t>(rand() % 12), 2);
+		append(static_cast<uint32_t>(static_cast<int>(rand() % 200) - 100), 2);
+		append(static_cast<uint32_t>(rand() % 100000), 4);
+	}
+	binary.data.resize(size);
+	result.push_back(std::move(binary));
+	return result;
+}
+
+
+// Runs the given program with the given arguments (the first being the program path),
+// waits for it to exit, and returns its wall-clock time and peak memory usage.
+static ProcessResult runProcess(const vector<string> &args) {
+	vector<char *> argv;
+	for (const string &arg : args)
+		argv.push_back(const_cast<char *>(arg.c_str()));
+	argv.push_back(nullptr);
+	
+	auto start = std::chrono::steady_clock::now();
+	pid_t pid = fork();
+	if (pid == -1)
+		throw std::runtime_error("Cannot create process");
+	if (pid == 0) {
+		execv(argv.at(0), argv.data());
+		std::cerr << "Cannot run " << args.at(0) << std::endl;
+		_exit(127);
+	}
+	int status;
+	struct rusage usage;
+	if (wait4(pid, &status, 0, &usage) != pid)
+		throw std::runtime_error("Cannot wait for process");
+	auto elapsed = std::chrono::steady_clock::now() - start;
+	return ProcessResult{
+		WIFEXITED(status) && WEXITSTATUS(status) == 0,
+		std::chrono::duration<double>(elapsed).count(),
+		usage.ru_maxrss,  // In kibibytes on Linux
+	};
+}
+
+
+static void writeFile(const string &path, const vector<char> &data) {
+	std::ofstream out(path.c_str(), std::ios::binary);
+	out.write(data.data(), static_cast<std::streamsize>(data.size()));
+	if (!out)
+		throw std::runtime_error("Cannot write " + path);
+}
+
+
+static vector<char> readFile(const string &path) {
+	std::ifstream in(path.c_str(), std::ios::binary);
+	if (!in)
+		return vector<char>();
+	return vector<char>(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+
+// Returns the given number in a form that is valid JSON, which has no infinity or NaN.
+static string formatNumber(double x) {
+	if (!(x >= 0 && x < 1e300))
+		return "null";
+	char buf[32];
+	std::snprintf(buf, sizeof(buf), "%.4f", x);
+	return buf;
+}
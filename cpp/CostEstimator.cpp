@@ -0,0 +1,310 @@
+/* 
+ * Reference arithmetic coding
+ * Copyright (c) Project Nayuki
+ * 
+ * https://www.nayuki.io/page/reference-arithmetic-coding
+ * https://github.com/nayuki/Reference-arithmetic-coding
+ */
+
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+#include "BitTreeModel.hpp"
+#include "ByteHistogram.hpp"
+#include "CostEstimator.hpp"
+#include "FrequencyHeader.hpp"
+#include "PpmModel.hpp"
+
+using std::uint8_t;
+using std::uint16_t;
+using std::uint32_t;
+using std::vector;
+
+
+// Arguments below 2^TABLE_BITS are looked up directly; larger ones are scaled down into this range first.
+static constexpr int TABLE_BITS = 12;
+static constexpr uint32_t TABLE_SIZE = UINT32_C(1) << TABLE_BITS;
+
+// LOG2_TABLE[i] = log2(i). There is one extra entry because rounding can produce TABLE_SIZE.
+static double LOG2_TABLE[TABLE_SIZE + 1];
+
+
+static bool initTable() {
+	LOG2_TABLE[0] = -std::numeric_limits<double>::infinity();
+	for (uint32_t i = 1; i <= TABLE_SIZE; i++)
+		LOG2_TABLE[i] = std::log2(static_cast<double>(i));
+	return true;
+}
+
+static const bool TABLE_INITIALIZED = initTable();
+
+
+// The sample for selectModel() consists of this many equally sized pieces.
+static constexpr int SAMPLE_PIECES = 4;
+
+// A slower model must have an estimated cost below this fraction of a faster model's cost to be chosen.
+static constexpr double SELECTION_MARGIN = 0.99;
+
+
+static vector<uint8_t> takeSample(const uint8_t *data, std::size_t len);
+static double estimateFromSample(BlockModel model, int ppmOrder, const vector<uint8_t> &sample, std::size_t len);
+static double estimateStaticParts(BlockModel model, const uint8_t *data, std::size_t len, double &headerBits);
+static double tableCost(const vector<uint32_t> &counts, int maxTotalBits, bool withEof, double &headerBits);
+static double bitCost(uint16_t &zeroProbability, int bit);
+static void checkLength(std::size_t len);
+
+
+double CostEstimator::estimate(BlockModel model, int ppmOrder, const uint8_t *data, std::size_t len) {
+	switch (model) {
+		case BlockModel::STATIC  :  return estimateStatic  (data, len);
+		case BlockModel::ADAPTIVE:  return estimateAdaptive(data, len);
+		case BlockModel::PPM     :  return estimatePpm(ppmOrder, data, len);
+		case BlockModel::STORED  :  return static_cast<double>(len) * 8;
+		case BlockModel::STATIC_ORDER1:  return estimateStaticOrder1(data, len);
+		case BlockModel::ADAPTIVE_BINARY:  return estimateAdaptiveBinary(data, len);
+		default:  throw std::domain_error("Unknown block model");
+	}
+}
+
+
+double CostEstimator::estimateStatic(const uint8_t *data, std::size_t len) {
+	double headerBits = 0;
+	double dataBits = estimateStaticParts(BlockModel::STATIC, data, len, headerBits);
+	return headerBits + dataBits;
+}
+
+
+double CostEstimator::estimateStaticOrder1(const uint8_t *data, std::size_t len) {
+	double headerBits = 0;
+	double dataBits = estimateStaticParts(BlockModel::STATIC_ORDER1, data, len, headerBits);
+	return headerBits + dataBits;
+}
+
+
+double CostEstimator::estimateAdaptive(const uint8_t *data, std::size_t len) {
+	checkLength(len);
+	// Same initial state as SimpleFrequencyTable(FlatFrequencyTable(257))
+	vector<uint32_t> counts(257, 1);
+	uint32_t total = 257;
+	double result = 0;
+	for (std::size_t i = 0; i < len; i++) {
+		uint32_t &count = counts[data[i]];
+		result += log2(total) - log2(count);
+		count++;
+		total++;
+	}
+	return result + log2(total) - log2(counts.at(256));  // EOF
+}
+
+
+double CostEstimator::estimateAdaptiveBinary(const uint8_t *data, std::size_t len) {
+	// Same initial state as BlockCodec's BitTreeModel instances
+	uint16_t half = static_cast<uint16_t>(UINT32_C(1) << (ArithmeticCoderBase::PROBABILITY_BITS - 1));
+	uint16_t endProbability = half;
+	vector<uint16_t> probabilities(256, half);
+	double result = 0;
+	for (std::size_t i = 0; i < len; i++) {
+		result += bitCost(endProbability, 0);
+		uint32_t node = 1;
+		for (int j = 7; j >= 0; j--) {
+			int bit = (data[i] >> j) & 1;
+			result += bitCost(probabilities[node], bit);
+			node = node << 1 | static_cast<uint32_t>(bit);
+		}
+	}
+	return result + bitCost(endProbability, 1);  // EOF
+}
+
+
+double CostEstimator::estimatePpm(int order, const uint8_t *data, std::size_t len) {
+	checkLength(len);
+	PpmModel model(order, 257, 256, true, true);
+	vector<uint32_t> history;
+	double result = 0;
+	for (std::size_t i = 0; ; i++) {
+		uint32_t symbol = i < len ? data[i] : 256;
+		
+		// Follow the same path through the contexts as PpmModel::encodeSymbol(), using only
+		// individual frequencies and totals, which SimpleFrequencyTable provides in constant time
+		bool coded = false;
+		for (int ord = static_cast<int>(history.size()); ord >= 0 && !coded; ord--) {
+			const PpmModel::Context *ctx = model.rootContext.get();
+			for (int j = 0; j < ord && ctx != nullptr; j++)
+				ctx = ctx->subcontexts.at(history.at(j)).get();
+			if (ctx == nullptr)
+				continue;
+			const SimpleFrequencyTable &freqs = ctx->frequencies;
+			coded = symbol != 256 && freqs.get(symbol) > 0;
+			result += log2(freqs.getTotal()) - log2(freqs.get(coded ? symbol : 256));
+		}
+		if (!coded) {
+			// Order -1 context, where a byte is 8 equiprobable bits after a binary decision (see PpmModel)
+			constexpr uint32_t ONE = UINT32_C(1) << ArithmeticCoderBase::PROBABILITY_BITS;
+			if (symbol != 256)
+				result += ArithmeticCoderBase::PROBABILITY_BITS - log2(PpmModel::ORDER_MINUS1_SYMBOL_PROBABILITY) + 8;
+			else
+				result += ArithmeticCoderBase::PROBABILITY_BITS - log2(ONE - PpmModel::ORDER_MINUS1_SYMBOL_PROBABILITY);
+		}
+		if (i == len)
+			break;
+		
+		model.incrementContexts(history, symbol);
+		model.pushHistory(history, symbol);
+	}
+	return result;
+}
+
+
+ModelChoice CostEstimator::selectModel(const uint8_t *data, std::size_t len) {
+	vector<uint8_t> sample = takeSample(data, len);
+	
+	// Candidates in order of increasing coding time
+	static const ModelChoice CANDIDATES[] = {
+		{BlockModel::STORED  , 0, 0},
+		{BlockModel::STATIC  , 0, 0},
+		{BlockModel::STATIC_ORDER1, 0, 0},
+		{BlockModel::ADAPTIVE_BINARY, 0, 0},
+		{BlockModel::ADAPTIVE, 0, 0},
+		{BlockModel::PPM     , 1, 0},
+		{BlockModel::PPM     , 2, 0},
+		{BlockModel::PPM     , 3, 0},
+	};
+	ModelChoice best = CANDIDATES[0];
+	best.estimatedBits = std::numeric_limits<double>::infinity();
+	for (ModelChoice cand : CANDIDATES) {
+		double bits = estimateFromSample(cand.model, cand.ppmOrder, sample, len);
+		cand.estimatedBits = bits;
+		if (bits < best.estimatedBits * SELECTION_MARGIN)
+			best = cand;
+		else if (cand.model == BlockModel::PPM && bits >= best.estimatedBits)
+			break;  // Higher orders are unlikely to help, and are slow to estimate on incompressible data
+	}
+	return best;
+}
+
+
+bool CostEstimator::isIncompressible(BlockModel model, int ppmOrder, const uint8_t *data, std::size_t len) {
+	if (model == BlockModel::STORED)
+		return true;
+	vector<uint8_t> sample = takeSample(data, len);
+	double limit = static_cast<double>(len) * 8;
+	// The order-0 cost is cheap to estimate, and if it already beats storing then
+	// so will any of the models, whose cost is roughly the same or lower
+	if (estimateFromSample(BlockModel::ADAPTIVE, 0, sample, len) < limit)
+		return false;
+	return estimateFromSample(model, ppmOrder, sample, len) >= limit;
+}
+
+
+double CostEstimator::log2(uint32_t x) {
+	(void)TABLE_INITIALIZED;
+	if (x < TABLE_SIZE)
+		return LOG2_TABLE[x];
+	int shift = 0;
+	while ((x >> shift) >= TABLE_SIZE)
+		shift++;
+	// Round to nearest, which halves the error compared to truncation
+	uint32_t scaled = static_cast<uint32_t>((static_cast<std::uint64_t>(x) + (UINT32_C(1) << (shift - 1))) >> shift);
+	return LOG2_TABLE[scaled] + shift;
+}
+
+
+// Returns the whole block if it is at most SAMPLE_SIZE bytes, otherwise evenly spaced contiguous pieces of it.
+static vector<uint8_t> takeSample(const uint8_t *data, std::size_t len) {
+	vector<uint8_t> result;
+	if (len <= CostEstimator::SAMPLE_SIZE)
+		result.assign(data, data + len);
+	else {
+		std::size_t pieceSize = CostEstimator::SAMPLE_SIZE / SAMPLE_PIECES;
+		for (int i = 0; i < SAMPLE_PIECES; i++) {
+			const uint8_t *start = data + (len - pieceSize) / (SAMPLE_PIECES - 1) * i;
+			result.insert(result.end(), start, start + pieceSize);
+		}
+	}
+	return result;
+}
+
+
+// Returns the estimated cost of the given sample, scaled up to a block of the given length. The static
+// model's frequency table header doesn't grow with the block length (taking the sample's table as an
+// approximation of the block's), whereas the rest scales with it.
+static double estimateFromSample(BlockModel model, int ppmOrder, const vector<uint8_t> &sample, std::size_t len) {
+	double scale = sample.empty() ? 1 : static_cast<double>(len) / sample.size();
+	if (model == BlockModel::STATIC || model == BlockModel::STATIC_ORDER1) {
+		double headerBits = 0;
+		double dataBits = estimateStaticParts(model, sample.data(), sample.size(), headerBits);
+		return dataBits * scale + headerBits;
+	} else
+		return CostEstimator::estimate(model, ppmOrder, sample.data(), sample.size()) * scale;
+}
+
+
+// Returns the cost of the coded data under the given static model (STATIC or STATIC_ORDER1),
+// and sets the given variable to the size of its frequency table header.
+static double estimateStaticParts(BlockModel model, const uint8_t *data, std::size_t len, double &headerBits) {
+	checkLength(len);
+	headerBits = 0;
+	if (model == BlockModel::STATIC)
+		return tableCost(ByteHistogram::count(data, len, 1), 16, true, headerBits);
+	
+	// Same contexts as BlockCodec's STATIC_ORDER1 model
+	vector<vector<uint32_t> > counts(256);
+	uint8_t prev = 0;
+	for (std::size_t i = 0; i < len; i++) {
+		if (counts[prev].empty())
+			counts[prev].resize(256, 0);
+		counts[prev][data[i]]++;
+		prev = data[i];
+	}
+	if (counts[prev].empty())
+		counts[prev].resize(256, 0);
+	headerBits = 256;  // Presence flags
+	double result = 0;
+	for (int i = 0; i < 256; i++) {
+		if (!counts[i].empty())
+			result += tableCost(counts[i], BlockCodec::ORDER1_TOTAL_BITS, i == prev, headerBits);
+	}
+	return result;
+}
+
+
+// Returns the cost of coding the given 256 byte counts (and one EOF symbol if requested)
+// with their table as normalized by FrequencyHeader, and adds the table's size to headerBits.
+static double tableCost(const vector<uint32_t> &counts, int maxTotalBits, bool withEof, double &headerBits) {
+	vector<uint32_t> freqs = FrequencyHeader::normalize(counts, maxTotalBits);
+	headerBits += static_cast<double>(FrequencyHeader::getBitLength(freqs));
+	uint32_t total = 0;
+	for (uint32_t freq : freqs)
+		total += freq;
+	double logTotal = CostEstimator::log2(total);
+	double result = withEof ? logTotal : 0;  // EOF, whose frequency is 1
+	for (int i = 0; i < 256; i++) {
+		if (counts[i] > 0)
+			result += counts[i] * (logTotal - CostEstimator::log2(freqs[i]));
+	}
+	return result;
+}
+
+
+// Returns the cost of coding the given bit with the given probability of a 0, and
+// adapts the probability towards the bit the same way as BitTreeModel does.
+static double bitCost(uint16_t &zeroProbability, int bit) {
+	constexpr uint32_t ONE = UINT32_C(1) << ArithmeticCoderBase::PROBABILITY_BITS;
+	if (bit == 0) {
+		double result = ArithmeticCoderBase::PROBABILITY_BITS - CostEstimator::log2(zeroProbability);
+		zeroProbability += static_cast<uint16_t>((ONE - zeroProbability) >> BitTreeModel::ADAPTATION_SHIFT);
+		return result;
+	} else {
+		double result = ArithmeticCoderBase::PROBABILITY_BITS - CostEstimator::log2(ONE - zeroProbability);
+		zeroProbability -= static_cast<uint16_t>(zeroProbability >> BitTreeModel::ADAPTATION_SHIFT);
+		return result;
+	}
+}
+
+
+// Throws an exception if the data is too long for the frequency totals to fit in a uint32_t.
+static void checkLength(std::size_t len) {
+	if (len >= UINT32_MAX - 257)
+		throw std::length_error("Data too long");
+}
@@ -0,0 +1,97 @@
+/* 
+ * Reference arithmetic coding
+ * Copyright (c) Project Nayuki
+ * 
+ * https://www.nayuki.io/page/reference-arithmetic-coding
+ * https://github.com/nayuki/Reference-arithmetic-coding
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "BlockCodec.hpp"
+
+
+/* 
+ * A model and PPM order for coding a block, as chosen by CostEstimator::selectModel().
+ */
+struct ModelChoice final {
+	
+	BlockModel model;
+	
+	// Only meaningful when the model is PPM.
+	int ppmOrder;
+	
+	// The estimated coded size of the whole block in bits.
+	double estimatedBits;
+	
+};
+
+
+
+/* 
+ * Estimates how many bits a byte sequence would take when compressed with one of the models
+ * that the applications use, without running an arithmetic coder or producing any output.
+ * Each estimate is the sum of -log2(freq/total) over the symbols that would be coded (including
+ * the end-of-data symbol and PPM escapes), plus the frequency table header for the static model.
+ * With 32 state bits the coder's actual output is within a few bits of this. The logarithms come
+ * from a lookup table, and no cumulative frequencies are computed, so an estimate is much faster
+ * than compressing - especially for the adaptive model, whose table update dominates coding time.
+ */
+class CostEstimator final {
+	
+	/*---- Constants ----*/
+	
+	// The maximum number of bytes of a block that selectModel() examines.
+	public: static constexpr std::size_t SAMPLE_SIZE = 1 << 16;
+	
+	
+	/*---- Methods ----*/
+	
+	// Returns the estimated compressed size in bits of the given data
+	// under the given model, in the format that BlockCodec produces.
+	public: static double estimate(BlockModel model, int ppmOrder, const std::uint8_t *data, std::size_t len);
+	
+	
+	// The static model of ArithmeticCompress: one frequency table of the whole data, stored in a header.
+	public: static double estimateStatic(const std::uint8_t *data, std::size_t len);
+	
+	
+	// The order-1 static model of ArithmeticCompress --order=1: one frequency table per previous byte value.
+	public: static double estimateStaticOrder1(const std::uint8_t *data, std::size_t len);
+	
+	
+	// The adaptive order-0 model of AdaptiveArithmeticCompress.
+	public: static double estimateAdaptive(const std::uint8_t *data, std::size_t len);
+	
+	
+	// The bit tree model of AdaptiveArithmeticCompress --binary.
+	public: static double estimateAdaptiveBinary(const std::uint8_t *data, std::size_t len);
+	
+	
+	// The PPM model of PpmCompress with the given order, which must be at least -1.
+	public: static double estimatePpm(int order, const std::uint8_t *data, std::size_t len);
+	
+	
+	// Returns the model that is expected to code the given block most compactly, among stored, static
+	// of order 0 and 1, adaptive binary, adaptive, and PPM at orders 1 to 3. The costs are estimated on a sample of at most
+	// SAMPLE_SIZE bytes taken from evenly spaced places in the block and scaled up to the block length, so
+	// the choice takes a small fraction of the time of coding a large block. Because the models are listed
+	// from fastest to slowest, a slower model is only chosen if it is estimated to save at least 1% over a
+	// faster one. Higher PPM orders are not tried once a PPM order is estimated to cost no less than the
+	// best model so far.
+	public: static ModelChoice selectModel(const std::uint8_t *data, std::size_t len);
+	
+	
+	// Returns whether coding the given block with the given model is estimated to take at least as
+	// many bits as storing it verbatim, based on the same kind of sample as selectModel(). The order-0
+	// cost is checked first, so most compressible data is recognized without estimating a PPM model.
+	public: static bool isIncompressible(BlockModel model, int ppmOrder, const std::uint8_t *data, std::size_t len);
+	
+	
+	// Returns an approximation of log2(x) for x > 0, with an absolute error below 0.0004.
+	// Values below 4096 are looked up directly. Returns negative infinity for x = 0.
+	public: static double log2(std::uint32_t x);
+	
+};
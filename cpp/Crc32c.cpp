@@ -0,0 +1,114 @@
+/* 
+ * Reference arithmetic coding
+ * Copyright (c) Project Nayuki
+ * 
+ * https://www.nayuki.io/page/reference-arithmetic-coding
+ * https://github.com/nayuki/Reference-arithmetic-coding
+ */
+
+#include <cstring>
+#include "Crc32c.hpp"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+	#include <nmmintrin.h>
+	#define CRC32C_X86 1
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+	#include <arm_acle.h>
+	#define CRC32C_ARM 1
+#endif
+
+using std::uint8_t;
+using std::uint32_t;
+using std::uint64_t;
+
+
+// Bit-reversed form of the Castagnoli polynomial 0x1EDC6F41.
+static constexpr uint32_t POLYNOMIAL = 0x82F63B78;
+
+
+// TABLES[k][b] is the CRC contribution of byte value b followed by k zero bytes, for slicing-by-8.
+static uint32_t TABLES[8][256];
+
+
+static bool initTables() {
+	for (uint32_t i = 0; i < 256; i++) {
+		uint32_t crc = i;
+		for (int j = 0; j < 8; j++)
+			crc = (crc >> 1) ^ ((crc & 1) * POLYNOMIAL);
+		TABLES[0][i] = crc;
+	}
+	for (uint32_t i = 0; i < 256; i++) {
+		for (int k = 1; k < 8; k++)
+			TABLES[k][i] = (TABLES[k - 1][i] >> 8) ^ TABLES[0][TABLES[k - 1][i] & 0xFF];
+	}
+	return true;
+}
+
+static const bool TABLES_INITIALIZED = initTables();
+
+
+static uint32_t updateSoftware(uint32_t crc, const uint8_t *data, std::size_t len) {
+	for (; len >= 8; data += 8, len -= 8) {
+		uint32_t lo = crc ^ (static_cast<uint32_t>(data[0]) | static_cast<uint32_t>(data[1]) << 8
+			| static_cast<uint32_t>(data[2]) << 16 | static_cast<uint32_t>(data[3]) << 24);
+		crc = TABLES[7][lo & 0xFF] ^ TABLES[6][(lo >> 8) & 0xFF]
+			^ TABLES[5][(lo >> 16) & 0xFF] ^ TABLES[4][lo >> 24]
+			^ TABLES[3][data[4]] ^ TABLES[2][data[5]]
+			^ TABLES[1][data[6]] ^ TABLES[0][data[7]];
+	}
+	for (; len > 0; data++, len--)
+		crc = (crc >> 8) ^ TABLES[0][(crc ^ *data) & 0xFF];
+	return crc;
+}
+
+
+#if CRC32C_X86
+
+__attribute__((target("sse4.2")))
+static uint32_t updateHardware(uint32_t crc, const uint8_t *data, std::size_t len) {
+	uint64_t c = crc;
+	for (; len >= 8; data += 8, len -= 8) {
+		uint64_t word;
+		std::memcpy(&word, data, sizeof(word));  // Little endian, as the instruction expects
+		c = _mm_crc32_u64(c, word);
+	}
+	uint32_t result = static_cast<uint32_t>(c);
+	for (; len > 0; data++, len--)
+		result = _mm_crc32_u8(result, *data);
+	return result;
+}
+
+static const bool HAVE_HARDWARE = __builtin_cpu_supports("sse4.2");
+
+#elif CRC32C_ARM
+
+static uint32_t updateHardware(uint32_t crc, const uint8_t *data, std::size_t len) {
+	for (; len >= 8; data += 8, len -= 8) {
+		uint64_t word;
+		std::memcpy(&word, data, sizeof(word));
+		crc = __crc32cd(crc, word);
+	}
+	for (; len > 0; data++, len--)
+		crc = __crc32cb(crc, *data);
+	return crc;
+}
+
+static const bool HAVE_HARDWARE = true;
+
+#endif
+
+
+uint32_t Crc32c::compute(const uint8_t *data, std::size_t len) {
+	return update(0, data, len);
+}
+
+
+uint32_t Crc32c::update(uint32_t crc, const uint8_t *data, std::size_t len) {
+	crc = ~crc;
+	#if CRC32C_X86 || CRC32C_ARM
+		if (HAVE_HARDWARE)
+			return ~updateHardware(crc, data, len);
+	#endif
+	(void)TABLES_INITIALIZED;
+	return ~updateSoftware(crc, data, len);
+}
@@ -0,0 +1,32 @@
+/* 
+ * Reference arithmetic coding
+ * Copyright (c) Project Nayuki
+ * 
+ * https://www.nayuki.io/page/reference-arithmetic-coding
+ * https://github.com/nayuki/Reference-arithmetic-coding
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+
+/* 
+ * Computes the CRC-32C (Castagnoli) checksum, which is the variant that x86 SSE4.2 and
+ * ARMv8 CRC instructions implement. The instructions are used when the CPU supports them,
+ * and otherwise a table-driven software implementation gives the same results.
+ */
+class Crc32c final {
+	
+	/*---- Methods ----*/
+	
+	// Returns the checksum of the given bytes.
+	public: static std::uint32_t compute(const std::uint8_t *data, std::size_t len);
+	
+	
+	// Returns the checksum of the concatenation of the data that produced the given checksum
+	// and the given bytes. The checksum of empty data is 0, so compute() is update(0, ...).
+	public: static std::uint32_t update(std::uint32_t crc, const std::uint8_t *data, std::size_t len);
+	
+};
@@ -0,0 +1,158 @@
+/* 
+ * Reference arithmetic coding
+ * Copyright (c) Project Nayuki
+ * 
+ * https://www.nayuki.io/page/reference-arithmetic-coding
+ * https://github.com/nayuki/Reference-arithmetic-coding
+ */
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include "FileStream.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+	#include <unistd.h>
+	#define FILE_STREAM_POSIX 1
+#endif
+
+
+FileStreamBuffer::FileStreamBuffer(const char *path, bool writing) :
+		file(nullptr),
+		ownsFile(false),
+		buffer(BUFFER_SIZE) {
+	if (std::strcmp(path, "-") == 0)
+		file = writing ? stdout : stdin;
+	else {
+		file = std::fopen(path, writing ? "wb" : "rb");
+		if (file == nullptr)
+			throw std::runtime_error(std::string("Cannot open file: ") + path);
+		ownsFile = true;
+	}
+	// The C library's own buffering is redundant with ours
+	std::setvbuf(file, nullptr, _IONBF, 0);
+	if (writing)
+		setp(buffer.data(), buffer.data() + buffer.size());
+	else
+		setg(buffer.data(), buffer.data(), buffer.data());
+}
+
+
+FileStreamBuffer::~FileStreamBuffer() {
+	flushBuffer();
+	if (ownsFile)
+		std::fclose(file);
+	else
+		std::fflush(file);
+}
+
+
+bool FileStreamBuffer::isSeekable() const {
+	return std::fseek(file, 0, SEEK_CUR) == 0;
+}
+
+
+FileStreamBuffer::int_type FileStreamBuffer::underflow() {
+	if (gptr() < egptr())
+		return traits_type::to_int_type(*gptr());
+	#if FILE_STREAM_POSIX
+		// Return whatever a pipe has available instead of waiting for a full buffer, so that a reader
+		// sees each message of a stream as soon as it arrives. The C file handle is unbuffered
+		// (see the constructor), so reading its descriptor directly keeps the two consistent.
+		ssize_t result;
+		do {
+			result = ::read(fileno(file), buffer.data(), buffer.size());
+		} while (result == -1 && errno == EINTR);
+		if (result == -1)
+			throw std::runtime_error("Error reading input file");
+		std::size_t n = static_cast<std::size_t>(result);
+	#else
+		std::size_t n = std::fread(buffer.data(), 1, buffer.size(), file);
+		if (n == 0 && std::ferror(file))
+			throw std::runtime_error("Error reading input file");
+	#endif
+	if (n == 0)
+		return traits_type::eof();
+	setg(buffer.data(), buffer.data(), buffer.data() + n);
+	return traits_type::to_int_type(*gptr());
+}
+
+
+FileStreamBuffer::int_type FileStreamBuffer::overflow(int_type ch) {
+	if (!flushBuffer())
+		return traits_type::eof();
+	if (traits_type::eq_int_type(ch, traits_type::eof()))
+		return traits_type::not_eof(ch);
+	*pptr() = traits_type::to_char_type(ch);
+	pbump(1);
+	return ch;
+}
+
+
+int FileStreamBuffer::sync() {
+	if (!flushBuffer())
+		return -1;
+	return std::fflush(file) == 0 ? 0 : -1;
+}
+
+
+FileStreamBuffer::pos_type FileStreamBuffer::seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode) {
+	if (pbase() != nullptr)
+		return pos_type(off_type(-1));  // Seeking is only supported for reading
+	int whence = dir == std::ios_base::beg ? SEEK_SET : (dir == std::ios_base::cur ? SEEK_CUR : SEEK_END);
+	if (dir == std::ios_base::cur)
+		off -= egptr() - gptr();  // The file position is ahead of the logical position by the buffered amount
+	if (std::fseek(file, static_cast<long>(off), whence) != 0)
+		return pos_type(off_type(-1));
+	setg(buffer.data(), buffer.data(), buffer.data());
+	long result = std::ftell(file);
+	return result == -1 ? pos_type(off_type(-1)) : pos_type(result);
+}
+
+
+FileStreamBuffer::pos_type FileStreamBuffer::seekpos(pos_type pos, std::ios_base::openmode which) {
+	return seekoff(off_type(pos), std::ios_base::beg, which);
+}
+
+
+bool FileStreamBuffer::flushBuffer() {
+	if (pbase() == nullptr)
+		return true;
+	std::size_t n = static_cast<std::size_t>(pptr() - pbase());
+	bool ok = std::fwrite(pbase(), 1, n, file) == n;
+	setp(buffer.data(), buffer.data() + buffer.size());
+	return ok;
+}
+
+
+InputFileStream::InputFileStream(const char *path) :
+		std::istream(nullptr),
+		streamBuffer(path, false) {
+	rdbuf(&streamBuffer);
+	exceptions(std::ios_base::badbit);  // Rethrow read errors from the stream buffer instead of reporting EOF
+}
+
+
+bool InputFileStream::isSeekable() const {
+	return streamBuffer.isSeekable();
+}
+
+
+OutputFileStream::OutputFileStream(const char *path) :
+		std::ostream(nullptr),
+		streamBuffer(path, true) {
+	rdbuf(&streamBuffer);
+}
+
+
+void OutputFileStream::finish() {
+	flush();
+	if (!*this)
+		throw std::runtime_error("Error writing output file");
+}
+
+
+OutputFileStream::~OutputFileStream() {
+	flush();
+}
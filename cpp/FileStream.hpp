@@ -0,0 +1,119 @@
+/* 
+ * Reference arithmetic coding
+ * Copyright (c) Project Nayuki
+ * 
+ * https://www.nayuki.io/page/reference-arithmetic-coding
+ * https://github.com/nayuki/Reference-arithmetic-coding
+ */
+
+#pragma once
+
+#include <cstdio>
+#include <istream>
+#include <ostream>
+#include <streambuf>
+#include <vector>
+
+
+/* 
+ * A stream buffer that transfers bytes to or from a C file handle in large blocks, so that
+ * byte-at-a-time readers and writers don't pay for a library or system call per byte.
+ * Each buffer object is used for either reading or writing, never both.
+ */
+class FileStreamBuffer final : public std::streambuf {
+	
+	/*---- Fields ----*/
+	
+	// The underlying file handle, which is either owned by this object or is stdin/stdout.
+	private: std::FILE *file;
+	
+	// Whether this object must close the file handle when it is destroyed.
+	private: bool ownsFile;
+	
+	// Storage for the get area (when reading) or the put area (when writing).
+	private: std::vector<char> buffer;
+	
+	
+	/*---- Constructor ----*/
+	
+	// Opens the file at the given path for reading (if writing is false) or writing (if writing is true).
+	// The path "-" denotes standard input or standard output respectively. Throws an exception if the file
+	// cannot be opened.
+	public: explicit FileStreamBuffer(const char *path, bool writing);
+	
+	
+	public: ~FileStreamBuffer() override;
+	
+	
+	/*---- Methods ----*/
+	
+	// Returns whether the underlying file supports seeking, which is false for pipes and terminals.
+	public: bool isSeekable() const;
+	
+	
+	// Throws an exception if reading the file fails, rather than reporting the end of the file.
+	protected: int_type underflow() override;
+	
+	
+	protected: int_type overflow(int_type ch) override;
+	
+	
+	protected: int sync() override;
+	
+	
+	protected: pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) override;
+	
+	
+	protected: pos_type seekpos(pos_type pos, std::ios_base::openmode which) override;
+	
+	
+	// Writes out the contents of the put area. Returns false if the underlying write failed.
+	private: bool flushBuffer();
+	
+	
+	// The size of the buffer in bytes.
+	private: static constexpr std::size_t BUFFER_SIZE = 1 << 18;
+	
+};
+
+
+
+/* 
+ * A binary byte input stream that reads from a file, or from standard input if the path is "-".
+ * A read error is thrown out of the reading operation as an exception, so it can't pass for the end of the data.
+ */
+class InputFileStream final : public std::istream {
+	
+	private: FileStreamBuffer streamBuffer;
+	
+	
+	public: explicit InputFileStream(const char *path);
+	
+	
+	// Returns whether this stream supports seeking back to an earlier position.
+	public: bool isSeekable() const;
+	
+};
+
+
+
+/* 
+ * A binary byte output stream that writes to a file, or to standard output if the path is "-".
+ * Buffered data is flushed when the stream is destroyed, but any error doing so is lost then,
+ * so a writer must call finish() after writing everything to learn whether the output is complete.
+ */
+class OutputFileStream final : public std::ostream {
+	
+	private: FileStreamBuffer streamBuffer;
+	
+	
+	public: explicit OutputFileStream(const char *path);
+	
+	
+	// Writes out all buffered data, and throws an exception if that or any earlier write to the file failed.
+	public: void finish();
+	
+	
+	public: ~OutputFileStream() override;
+	
+};
@@ -0,0 +1,133 @@
+/* 
+ * Reference arithmetic coding
+ * Copyright (c) Project Nayuki
+ * 
+ * https://www.nayuki.io/page/reference-arithmetic-coding
+ * https://github.com/nayuki/Reference-arithmetic-coding
+ */
+
+#include <cstddef>
+#include <stdexcept>
+#include "FrequencyHeader.hpp"
+#include "FrequencyQuantizer.hpp"
+
+using std::uint32_t;
+using std::uint64_t;
+using std::vector;
+
+
+static void writeGamma(uint32_t val, BitOutputStream &out);
+static uint32_t readGamma(BitInputStream &in);
+static int gammaLength(uint32_t val);
+
+
+vector<uint32_t> FrequencyHeader::normalize(const vector<uint32_t> &counts, int maxTotalBits) {
+	if (counts.size() != 256)
+		throw std::invalid_argument("Expected 256 byte counts");
+	if (maxTotalBits < 9 || maxTotalBits > 16)  // 2^9 - 1 is enough for 256 nonzero counts
+		throw std::domain_error("Total bits out of range");
+	SimpleFrequencyTable table(counts);  // Checks that the sum fits in a uint32_t
+	
+	// With the EOF symbol's frequency of 1, the total is the smallest power of two above the sum of the
+	// counts, or 2^maxTotalBits for large inputs. Counts are scaled up as well as down, which barely
+	// changes their proportions, so that a static coder always gets a power-of-two total.
+	uint32_t total = 1;
+	while (total - 1 < table.getTotal() && total < UINT32_C(1) << maxTotalBits)
+		total <<= 1;
+	vector<uint32_t> result = FrequencyQuantizer::quantize(table, total - 1);
+	result.push_back(1);  // EOF
+	return result;
+}
+
+
+void FrequencyHeader::write(const vector<uint32_t> &freqs, BitOutputStream &out) {
+	if (freqs.size() < 256)
+		throw std::invalid_argument("Expected at least 256 frequencies");
+	for (std::size_t i = 0; i < 256; ) {
+		if (freqs[i] > MAX_TOTAL)
+			throw std::domain_error("Frequency not normalized");
+		if (freqs[i] > 0) {
+			out.write(1);
+			writeGamma(freqs[i], out);
+			i++;
+		} else {
+			std::size_t start = i;
+			for (; i < 256 && freqs[i] == 0; i++);
+			out.write(0);
+			writeGamma(static_cast<uint32_t>(i - start), out);
+		}
+	}
+}
+
+
+vector<uint32_t> FrequencyHeader::read(BitInputStream &in) {
+	vector<uint32_t> result;
+	uint32_t total = 0;
+	while (result.size() < 256) {
+		if (in.readNoEof() == 1) {
+			uint32_t freq = readGamma(in);
+			if (freq > MAX_TOTAL - total)
+				throw std::runtime_error("Frequency table total too large");
+			total += freq;
+			result.push_back(freq);
+		} else {
+			uint32_t run = readGamma(in);
+			if (run > 256 - result.size())
+				throw std::runtime_error("Frequency table too long");
+			result.resize(result.size() + run, 0);
+		}
+	}
+	result.push_back(1);  // EOF
+	return result;
+}
+
+
+long FrequencyHeader::getBitLength(const vector<uint32_t> &freqs) {
+	if (freqs.size() < 256)
+		throw std::invalid_argument("Expected at least 256 frequencies");
+	long result = 0;
+	for (std::size_t i = 0; i < 256; ) {
+		if (freqs[i] > 0) {
+			result += 1 + gammaLength(freqs[i]);
+			i++;
+		} else {
+			std::size_t start = i;
+			for (; i < 256 && freqs[i] == 0; i++);
+			result += 1 + gammaLength(static_cast<uint32_t>(i - start));
+		}
+	}
+	return result;
+}
+
+
+// Writes the given positive value as n zero bits followed by the n+1 bits of the value, where n = floor(log2(val)).
+static void writeGamma(uint32_t val, BitOutputStream &out) {
+	int n = gammaLength(val) / 2;
+	for (int i = 0; i < n; i++)
+		out.write(0);
+	for (int i = n; i >= 0; i--)
+		out.write(static_cast<int>((val >> i) & 1));
+}
+
+
+static uint32_t readGamma(BitInputStream &in) {
+	int n = 0;
+	while (in.readNoEof() == 0) {
+		n++;
+		if (n > 16)  // No stored value exceeds MAX_TOTAL
+			throw std::runtime_error("Malformed frequency table");
+	}
+	uint32_t result = 1;
+	for (int i = 0; i < n; i++)
+		result = (result << 1) | static_cast<uint32_t>(in.readNoEof());
+	return result;
+}
+
+
+// Returns the length of the Elias gamma code of the given positive value.
+static int gammaLength(uint32_t val) {
+	int n = 0;
+	while ((val >> n) > 1)
+		n++;
+	return n * 2 + 1;
+}
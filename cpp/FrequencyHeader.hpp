@@ -0,0 +1,57 @@
+/* 
+ * Reference arithmetic coding
+ * Copyright (c) Project Nayuki
+ * 
+ * https://www.nayuki.io/page/reference-arithmetic-coding
+ * https://github.com/nayuki/Reference-arithmetic-coding
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "BitIoStream.hpp"
+
+
+/* 
+ * The frequency table that precedes the coded data in the static model's format. The byte counts
+ * of the input are first normalized with FrequencyQuantizer so that they sum to at most MAX_TOTAL
+ * and the total including the EOF symbol is a power of two, keeping every nonzero count nonzero.
+ * So each frequency needs at most 16 bits, and the coder can use shifts instead of divisions.
+ * (The reader accepts any total up to MAX_TOTAL.) The table is then written as a sequence
+ * of items, where each item is either one nonzero frequency (a 1 bit followed by the frequency as
+ * an Elias gamma code) or a run of consecutive zero frequencies (a 0 bit followed by the run length
+ * as an Elias gamma code), until all 256 byte values are covered. The EOF symbol (256) is not stored
+ * and always has frequency 1. A typical text file's table takes about 150 to 250 bytes, and the
+ * table of a file with few distinct byte values takes only a few bytes.
+ */
+class FrequencyHeader final {
+	
+	/*---- Constants ----*/
+	
+	// The maximum sum of the 256 byte frequencies after normalization.
+	public: static constexpr std::uint32_t MAX_TOTAL = (UINT32_C(1) << 16) - 1;
+	
+	
+	/*---- Methods ----*/
+	
+	// Returns a table of 257 frequencies for the given 256 byte counts, in which the byte frequencies are
+	// the counts scaled to sum to 2^k - 1 for the smallest k such that this is at least the sum of the counts
+	// (but at most maxTotalBits, which is in the range [9, 16]), every nonzero count stays nonzero, and the
+	// EOF symbol has frequency 1. Throws an exception if the sum of the counts exceeds UINT32_MAX.
+	public: static std::vector<std::uint32_t> normalize(const std::vector<std::uint32_t> &counts, int maxTotalBits=16);
+	
+	
+	// Writes the byte frequencies (the first 256 elements) of the given normalized table to the given stream.
+	public: static void write(const std::vector<std::uint32_t> &freqs, BitOutputStream &out);
+	
+	
+	// Reads a table written by write() and returns the 257 frequencies, with the EOF symbol's being 1.
+	// Throws an exception if the data is malformed or ends early.
+	public: static std::vector<std::uint32_t> read(BitInputStream &in);
+	
+	
+	// Returns the number of bits that write() produces for the given normalized table.
+	public: static long getBitLength(const std::vector<std::uint32_t> &freqs);
+	
+};
@@ -0,0 +1,262 @@
+/* 
+ * Round-trip and edge-case tests for FrequencyHeader and FrequencyQuantizer
+ * 
+ * Usage: FrequencyHeaderTest
+ * This normalizes byte histograms ranging from empty to near the 32-bit limit, checks that each result
+ * has the promised power-of-two total and keeps the same symbols, writes it in the compact table encoding,
+ * and checks that it reads back unchanged. It also checks that malformed tables are rejected. The exit
+ * status is zero if every test passes.
+ * 
+ * Copyright (c) Project Nayuki
+ * 
+ * https://www.nayuki.io/page/reference-arithmetic-coding
+ * https://github.com/nayuki/Reference-arithmetic-coding
+ */
+
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "BitIoStream.hpp"
+#include "FrequencyHeader.hpp"
+#include "FrequencyQuantizer.hpp"
+#include "FrequencyTable.hpp"
+
+using std::uint32_t;
+using std::uint64_t;
+using std::vector;
+
+
+static void testAllZero();
+static void testSingleSymbol();
+static void testLargeCounts();
+static void testRandomHistograms();
+static void testQuantize();
+static void testMalformed();
+static void checkRoundTrip(const vector<uint32_t> &counts, int maxTotalBits=16);
+static std::string writeTable(const vector<uint32_t> &freqs);
+static vector<uint32_t> readTable(const std::string &data);
+static bool readFails(const std::string &data);
+static std::string fromBits(const std::string &bits);
+static void check(bool cond, const std::string &msg);
+
+
+int main() {
+	try {
+		testAllZero();
+		testSingleSymbol();
+		testLargeCounts();
+		testRandomHistograms();
+		testQuantize();
+		testMalformed();
+		std::cerr << "Test passed" << std::endl;
+		return EXIT_SUCCESS;
+	} catch (const std::exception &e) {
+		std::cerr << "Test failed: " << e.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+}
+
+
+// An empty input has only the EOF symbol, and its table is a single run of 256 zeros.
+static void testAllZero() {
+	vector<uint32_t> counts(256, 0);
+	vector<uint32_t> freqs = FrequencyHeader::normalize(counts);
+	check(freqs == [] { vector<uint32_t> v(256, 0); v.push_back(1); return v; }(), "All-zero table mismatch");
+	check(FrequencyHeader::getBitLength(freqs) == 1 + 17, "All-zero table length mismatch");  // 256 = 2^8 in gamma code
+	checkRoundTrip(counts);
+	checkRoundTrip(counts, 9);
+}
+
+
+// A single used symbol keeps all of the total except EOF's unit, at the first and last byte values and between.
+static void testSingleSymbol() {
+	for (uint32_t sym : {0, 1, 97, 255}) {
+		for (uint32_t count : {UINT32_C(1), UINT32_C(2), UINT32_C(7), UINT32_C(8), UINT32_C(1000), UINT32_C(65535), UINT32_C(65536), UINT32_MAX}) {
+			vector<uint32_t> counts(256, 0);
+			counts[sym] = count;
+			vector<uint32_t> freqs = FrequencyHeader::normalize(counts);
+			uint32_t total = 1;
+			while (total - 1 < count && total < UINT32_C(1) << 16)
+				total <<= 1;
+			check(freqs[sym] == total - 1, "Single symbol frequency mismatch");
+			checkRoundTrip(counts);
+		}
+	}
+}
+
+
+// Counts whose sum is at or near UINT32_MAX, which is the largest sum normalize() accepts.
+static void testLargeCounts() {
+	vector<uint32_t> counts(256, 1);
+	counts[0] = UINT32_MAX - 255;  // Sum is exactly UINT32_MAX, and the 255 small counts must stay 1
+	checkRoundTrip(counts);
+	checkRoundTrip(counts, 9);
+	vector<uint32_t> freqs = FrequencyHeader::normalize(counts);
+	for (int i = 1; i < 256; i++)
+		check(freqs[i] == 1, "Small count not kept at 1");
+
+	counts.assign(256, 0);
+	counts[10] = UINT32_MAX / 2;
+	counts[200] = UINT32_MAX / 2;
+	checkRoundTrip(counts);
+
+	counts.assign(256, UINT32_MAX / 256);  // Every symbol used, with the sum just under the limit
+	checkRoundTrip(counts);
+	checkRoundTrip(counts, 9);
+
+	counts[0] = UINT32_MAX;  // Sum overflows
+	bool thrown = false;
+	try {
+		FrequencyHeader::normalize(counts);
+	} catch (const std::exception &) {
+		thrown = true;
+	}
+	check(thrown, "Overflowing sum accepted");
+}
+
+
+// Skewed histograms with varied numbers of used symbols, normalized to every allowed maximum total.
+static void testRandomHistograms() {
+	std::mt19937 random(1);
+	for (int trial = 0; trial < 300; trial++) {
+		vector<uint32_t> counts(256, 0);
+		int numUsed = static_cast<int>(random() % 257);
+		uint32_t maxCount = UINT32_C(1) << (random() % 24);
+		for (int i = 0; i < numUsed; i++)
+			counts[random() % 256] = 1 + random() % maxCount;
+		checkRoundTrip(counts, 9 + trial % 8);
+	}
+}
+
+
+// FrequencyQuantizer hits the exact total, including totals below the sum and above it.
+static void testQuantize() {
+	std::mt19937 random(2);
+	for (int trial = 0; trial < 100; trial++) {
+		vector<uint32_t> counts(1 + random() % 300, 0);
+		uint32_t numNonzero = 0;
+		for (uint32_t &c : counts) {
+			if (random() % 3 != 0) {
+				c = 1 + random() % (UINT32_C(1) << (random() % 20));
+				numNonzero++;
+			}
+		}
+		if (numNonzero == 0)
+			continue;
+		SimpleFrequencyTable table(counts);
+		for (uint32_t total : {numNonzero, numNonzero + 1, UINT32_C(4096), table.getTotal(), UINT32_C(1) << 24}) {
+			if (total < numNonzero)
+				continue;
+			vector<uint32_t> freqs = FrequencyQuantizer::quantize(table, total);
+			uint64_t sum = 0;
+			for (std::size_t i = 0; i < counts.size(); i++) {
+				check((freqs[i] == 0) == (counts[i] == 0), "Quantized table changed the used symbols");
+				sum += freqs[i];
+			}
+			check(sum == total, "Quantized total mismatch");
+			if (total == table.getTotal())
+				check(freqs == counts, "Quantizing to the same total changed the counts");
+		}
+		bool thrown = false;
+		try {
+			FrequencyQuantizer::quantize(table, numNonzero - 1);
+		} catch (const std::invalid_argument &) {
+			thrown = true;
+		}
+		check(thrown, "Unreachable total accepted");
+	}
+	check(FrequencyQuantizer::toPowerOfTwo(SimpleFrequencyTable(vector<uint32_t>{3, 0, 5}), 4).getTotal() == 16, "Power-of-two total mismatch");
+}
+
+
+// The reader must reject data that write() never produces.
+static void testMalformed() {
+	vector<uint32_t> freqs(256, 0);
+	freqs[0] = 1000;
+	freqs[255] = 3;
+	std::string data = writeTable(freqs);
+	for (std::size_t len = 0; len < data.size(); len++)
+		check(readFails(data.substr(0, len)), "Truncated table accepted");
+
+	freqs.assign(256, 0);
+	freqs[0] = FrequencyHeader::MAX_TOTAL;
+	freqs[1] = 1;
+	check(readFails(writeTable(freqs)), "Table with too large a total accepted");
+
+	check(readFails(fromBits("0" "00000000" "100000001")), "Run past the end of the table accepted");  // Run of 257
+	check(readFails(fromBits("1" "00000000000000000" "10000000000000000")), "Overlong gamma code accepted");  // 2^17
+	check(readFails(fromBits("0" "0000000" "10000000" "0" "0000000" "10000001")), "Run past the end of the table accepted");  // 128 + 129
+	check(!readFails(fromBits("0" "0000000" "10000000" "0" "0000000" "10000000")), "Two runs of 128 rejected");
+}
+
+
+// Normalizes the given counts and checks the result's properties, then that it survives writing and reading.
+static void checkRoundTrip(const vector<uint32_t> &counts, int maxTotalBits) {
+	vector<uint32_t> freqs = FrequencyHeader::normalize(counts, maxTotalBits);
+	check(freqs.size() == 257 && freqs[256] == 1, "Normalized table has no EOF symbol");
+	uint64_t sum = 0;
+	uint64_t countSum = 0;
+	for (int i = 0; i < 256; i++) {
+		check((freqs[i] == 0) == (counts[i] == 0), "Normalized table changed the used symbols");
+		sum += freqs[i];
+		countSum += counts[i];
+	}
+	uint64_t total = sum + 1;
+	check((total & (total - 1)) == 0, "Normalized total is not a power of two");
+	check(total <= UINT64_C(1) << maxTotalBits, "Normalized total too large");
+	check(sum >= countSum || total == UINT64_C(1) << maxTotalBits, "Normalized total is not the smallest power of two");
+	check(total == 1 || sum < countSum || total / 2 - 1 < countSum, "Normalized total is not the smallest power of two");
+
+	std::string data = writeTable(freqs);
+	long bits = FrequencyHeader::getBitLength(freqs);
+	check(static_cast<long>(data.size()) == (bits + 7) / 8, "Written length differs from getBitLength()");
+	check(readTable(data) == freqs, "Table read back differs");
+}
+
+
+static std::string writeTable(const vector<uint32_t> &freqs) {
+	std::ostringstream out;
+	BitOutputStream bout(out);
+	FrequencyHeader::write(freqs, bout);
+	bout.finish();
+	return out.str();
+}
+
+
+static vector<uint32_t> readTable(const std::string &data) {
+	std::istringstream in(data);
+	BitInputStream bin(in);
+	return FrequencyHeader::read(bin);
+}
+
+
+static bool readFails(const std::string &data) {
+	try {
+		readTable(data);
+		return false;
+	} catch (const std::runtime_error &) {
+		return true;
+	}
+}
+
+
+// Returns the bytes of the given string of '0' and '1' characters, padded with zero bits.
+static std::string fromBits(const std::string &bits) {
+	std::ostringstream out;
+	BitOutputStream bout(out);
+	for (char c : bits)
+		bout.write(c == '1' ? 1 : 0);
+	bout.finish();
+	return out.str();
+}
+
+
+static void check(bool cond, const std::string &msg) {
+	if (!cond)
+		throw std::logic_error(msg);
+}
@@ -0,0 +1,92 @@
+/* 
+ * Reference arithmetic coding
+ * Copyright (c) Project Nayuki
+ * 
+ * https://www.nayuki.io/page/reference-arithmetic-coding
+ * https://github.com/nayuki/Reference-arithmetic-coding
+ */
+
+#include <cmath>
+#include <cstddef>
+#include <queue>
+#include <stdexcept>
+#include <utility>
+#include "FrequencyQuantizer.hpp"
+
+using std::uint32_t;
+using std::uint64_t;
+using std::vector;
+
+
+// Returns how much the coding cost of the given count drops when its frequency grows from freq to freq + 1.
+static double gain(uint32_t count, uint32_t freq);
+
+
+vector<uint32_t> FrequencyQuantizer::quantize(const FrequencyTable &counts, uint32_t total) {
+	uint32_t numSymbols = counts.getSymbolLimit();
+	uint64_t sum = 0;
+	uint32_t numNonzero = 0;
+	for (uint32_t i = 0; i < numSymbols; i++) {
+		sum += counts.get(i);
+		if (counts.get(i) > 0)
+			numNonzero++;
+	}
+	if (total < numNonzero || (sum == 0 && total != 0))
+		throw std::invalid_argument("Total cannot be reached");
+	
+	// Start from the truncated scaled counts, raised to 1 where needed. This can
+	// undershoot the total by up to the number of symbols, or overshoot it by up to
+	// the number of counts that were raised from 0 to 1.
+	vector<uint32_t> result(numSymbols, 0);
+	uint64_t newSum = 0;
+	for (uint32_t i = 0; i < numSymbols; i++) {
+		uint32_t count = counts.get(i);
+		if (count > 0) {
+			uint64_t scaled = count * static_cast<uint64_t>(total) / sum;
+			result[i] = static_cast<uint32_t>(scaled > 0 ? scaled : 1);
+			newSum += result[i];
+		}
+	}
+	
+	if (newSum < total) {
+		// Give each remaining unit to the symbol that gains the most from it
+		std::priority_queue<std::pair<double,uint32_t> > queue;
+		for (uint32_t i = 0; i < numSymbols; i++) {
+			if (result[i] > 0)
+				queue.emplace(gain(counts.get(i), result[i]), i);
+		}
+		for (; newSum < total; newSum++) {
+			uint32_t i = queue.top().second;
+			queue.pop();
+			result[i]++;
+			queue.emplace(gain(counts.get(i), result[i]), i);
+		}
+	} else if (newSum > total) {
+		// Take each excess unit from the symbol that loses the least by it, never going below 1
+		std::priority_queue<std::pair<double,uint32_t> > queue;
+		for (uint32_t i = 0; i < numSymbols; i++) {
+			if (result[i] > 1)
+				queue.emplace(-gain(counts.get(i), result[i] - 1), i);
+		}
+		for (; newSum > total; newSum--) {
+			uint32_t i = queue.top().second;
+			queue.pop();
+			result[i]--;
+			if (result[i] > 1)
+				queue.emplace(-gain(counts.get(i), result[i] - 1), i);
+		}
+	}
+	return result;
+}
+
+
+SimpleFrequencyTable FrequencyQuantizer::toPowerOfTwo(const FrequencyTable &counts, int totalBits) {
+	if (totalBits < 0 || totalBits > 31)
+		throw std::domain_error("Total bits out of range");
+	return SimpleFrequencyTable(quantize(counts, UINT32_C(1) << totalBits));
+}
+
+
+static double gain(uint32_t count, uint32_t freq) {
+	return count * (std::log2(freq + 1.0) - std::log2(static_cast<double>(freq)));
+}
@@ -0,0 +1,40 @@
+/* 
+ * Reference arithmetic coding
+ * Copyright (c) Project Nayuki
+ * 
+ * https://www.nayuki.io/page/reference-arithmetic-coding
+ * https://github.com/nayuki/Reference-arithmetic-coding
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "FrequencyTable.hpp"
+
+
+/* 
+ * Scales a table of symbol counts to a table with a chosen total, such as a power of two,
+ * which the arithmetic coder handles with shifts instead of divisions. Every nonzero count
+ * stays nonzero and every zero count stays zero. The result aims to minimize the cost of coding
+ * the original counts, sum(count[i] * -log2(freq[i] / total)): the counts are first scaled with
+ * truncation, and then the remaining units are handed out one at a time to whichever symbol's
+ * cost drops the most from one more unit (or, if raising small counts to 1 overshot the total,
+ * taken back from whichever symbols lose the least). Because the cost is convex in each frequency,
+ * these marginal choices converge on the best table reachable from the truncated start.
+ */
+class FrequencyQuantizer final {
+	
+	/*---- Methods ----*/
+	
+	// Returns frequencies for the same symbols as the given counts that sum to exactly the given total.
+	// Throws an exception if the total is less than the number of nonzero counts, or is nonzero when
+	// all the counts are zero.
+	public: static std::vector<std::uint32_t> quantize(const FrequencyTable &counts, std::uint32_t total);
+	
+	
+	// Returns a table with the same symbols as the given counts whose total is exactly 2^totalBits,
+	// where totalBits is in the range [0, 31]. See quantize() for the requirements.
+	public: static SimpleFrequencyTable toPowerOfTwo(const FrequencyTable &counts, int totalBits);
+	
+};
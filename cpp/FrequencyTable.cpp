@@ -6,6 +6,8 @@
  * https://github.com/nayuki/Reference-arithmetic-coding
  */
 
+#include <algorithm>
+#include <cstddef>
 #include <stdexcept>
 #include "FrequencyTable.hpp"
 
@@ -164,3 +166,263 @@ uint32_t SimpleFrequencyTable::checkedAdd(uint32_t x, uint32_t y) {
 		throw std::overflow_error("Arithmetic overflow");
 	return x + y;
 }
+
+
+LookupFrequencyTable::LookupFrequencyTable(const FrequencyTable &freqs) {
+	uint32_t size = freqs.getSymbolLimit();
+	if (size < 1)
+		throw std::invalid_argument("At least 1 symbol needed");
+	if (size > UINT32_C(1) << 16)
+		throw std::length_error("Too many symbols");
+	uint32_t total = freqs.getTotal();
+	if (total < 1 || total > MAX_TOTAL)
+		throw std::domain_error("Total out of range");
+	
+	cumulative.reserve(size + 1);
+	cumulative.push_back(0);
+	symbols.reserve(total);
+	for (uint32_t i = 0; i < size; i++) {
+		uint32_t freq = freqs.get(i);
+		if (freq > total - cumulative.back())
+			throw std::logic_error("Assertion error");
+		cumulative.push_back(cumulative.back() + freq);
+		symbols.insert(symbols.end(), freq, static_cast<std::uint16_t>(i));
+	}
+	if (cumulative.back() != total)
+		throw std::logic_error("Assertion error");
+}
+
+
+uint32_t LookupFrequencyTable::getSymbolLimit() const {
+	return static_cast<uint32_t>(cumulative.size() - 1);
+}
+
+
+uint32_t LookupFrequencyTable::get(uint32_t symbol) const {
+	return getHigh(symbol) - getLow(symbol);
+}
+
+
+uint32_t LookupFrequencyTable::getTotal() const {
+	return cumulative.back();
+}
+
+
+uint32_t LookupFrequencyTable::getLow(uint32_t symbol) const {
+	if (symbol >= getSymbolLimit())
+		throw std::domain_error("Symbol out of range");
+	return cumulative[symbol];
+}
+
+
+uint32_t LookupFrequencyTable::getHigh(uint32_t symbol) const {
+	if (symbol >= getSymbolLimit())
+		throw std::domain_error("Symbol out of range");
+	return cumulative[symbol + 1];
+}
+
+
+void LookupFrequencyTable::set(uint32_t, uint32_t) {
+	throw std::logic_error("Unsupported operation");
+}
+
+
+void LookupFrequencyTable::increment(uint32_t) {
+	throw std::logic_error("Unsupported operation");
+}
+
+
+uint32_t LookupFrequencyTable::getSymbol(uint32_t value) const {
+	return symbols.at(value);
+}
+
+
+FenwickFrequencyTable::FenwickFrequencyTable(const FrequencyTable &freqs) {
+	uint32_t size = freqs.getSymbolLimit();
+	if (size < 1)
+		throw std::invalid_argument("At least 1 symbol needed");
+	if (size > UINT32_MAX - 1)
+		throw std::length_error("Too many symbols");
+	
+	frequencies.reserve(size);
+	tree.assign(static_cast<std::size_t>(size) + 1, 0);
+	total = 0;
+	for (uint32_t i = 0; i < size; i++) {
+		uint32_t freq = freqs.get(i);
+		if (freq > UINT32_MAX - total)
+			throw std::overflow_error("Arithmetic overflow");
+		total += freq;
+		frequencies.push_back(freq);
+		tree[i + 1] = freq;
+	}
+	// Build the tree in linear time by pushing each partial sum up to its parent
+	for (std::size_t i = 1; i <= size; i++) {
+		std::size_t parent = i + (i & (~i + 1));
+		if (parent <= size)
+			tree[parent] += tree[i];
+	}
+}
+
+
+uint32_t FenwickFrequencyTable::getSymbolLimit() const {
+	return static_cast<uint32_t>(frequencies.size());
+}
+
+
+uint32_t FenwickFrequencyTable::get(uint32_t symbol) const {
+	return frequencies.at(symbol);
+}
+
+
+void FenwickFrequencyTable::set(uint32_t symbol, uint32_t freq) {
+	uint32_t old = frequencies.at(symbol);
+	if (freq > old && freq - old > UINT32_MAX - total)
+		throw std::overflow_error("Arithmetic overflow");
+	total = total - old + freq;
+	frequencies.at(symbol) = freq;
+	addToTree(symbol, freq - old);
+}
+
+
+void FenwickFrequencyTable::increment(uint32_t symbol) {
+	if (frequencies.at(symbol) == UINT32_MAX || total == UINT32_MAX)
+		throw std::overflow_error("Arithmetic overflow");
+	total++;
+	frequencies.at(symbol)++;
+	addToTree(symbol, 1);
+}
+
+
+uint32_t FenwickFrequencyTable::getTotal() const {
+	return total;
+}
+
+
+uint32_t FenwickFrequencyTable::getLow(uint32_t symbol) const {
+	if (symbol >= frequencies.size())
+		throw std::domain_error("Symbol out of range");
+	uint32_t result = 0;
+	for (std::size_t i = symbol; i > 0; i &= i - 1)  // Clear the lowest set bit
+		result += tree[i];
+	return result;
+}
+
+
+uint32_t FenwickFrequencyTable::getHigh(uint32_t symbol) const {
+	return getLow(symbol) + frequencies.at(symbol);
+}
+
+
+uint32_t FenwickFrequencyTable::getSymbol(uint32_t value) const {
+	if (value >= total)
+		throw std::domain_error("Value out of range");
+	std::size_t size = frequencies.size();
+	std::size_t step = 1;
+	while (step <= size / 2)
+		step <<= 1;
+	// Find the highest position whose prefix sum is at most the value; that prefix ends just before the symbol
+	std::size_t pos = 0;
+	for (; step > 0; step >>= 1) {
+		if (pos + step <= size && tree[pos + step] <= value) {
+			pos += step;
+			value -= tree[pos];
+		}
+	}
+	return static_cast<uint32_t>(pos);
+}
+
+
+void FenwickFrequencyTable::addToTree(uint32_t symbol, uint32_t delta) {
+	std::size_t size = frequencies.size();
+	for (std::size_t i = static_cast<std::size_t>(symbol) + 1; i <= size; i += i & (~i + 1))
+		tree[i] += delta;
+}
+
+
+SparseFrequencyTable::SparseFrequencyTable(uint32_t numSyms) :
+		numSymbols(numSyms),
+		total(0) {
+	if (numSyms < 1)
+		throw std::domain_error("Number of symbols must be positive");
+}
+
+
+uint32_t SparseFrequencyTable::getSymbolLimit() const {
+	return numSymbols;
+}
+
+
+uint32_t SparseFrequencyTable::get(uint32_t symbol) const {
+	std::size_t index = find(symbol);
+	return index < symbols.size() && symbols[index] == symbol ? frequencies[index] : 0;
+}
+
+
+void SparseFrequencyTable::set(uint32_t symbol, uint32_t freq) {
+	std::size_t index = find(symbol);
+	bool exists = index < symbols.size() && symbols[index] == symbol;
+	uint32_t old = exists ? frequencies[index] : 0;
+	if (freq > old && freq - old > UINT32_MAX - total)
+		throw std::overflow_error("Arithmetic overflow");
+	total = total - old + freq;
+	if (exists && freq == 0) {
+		symbols.erase(symbols.begin() + static_cast<std::ptrdiff_t>(index));
+		frequencies.erase(frequencies.begin() + static_cast<std::ptrdiff_t>(index));
+	} else if (exists)
+		frequencies[index] = freq;
+	else if (freq > 0) {
+		symbols.insert(symbols.begin() + static_cast<std::ptrdiff_t>(index), symbol);
+		frequencies.insert(frequencies.begin() + static_cast<std::ptrdiff_t>(index), freq);
+	}
+}
+
+
+void SparseFrequencyTable::increment(uint32_t symbol) {
+	std::size_t index = find(symbol);
+	if (total == UINT32_MAX)
+		throw std::overflow_error("Arithmetic overflow");
+	if (index < symbols.size() && symbols[index] == symbol)
+		frequencies[index]++;
+	else {
+		symbols.insert(symbols.begin() + static_cast<std::ptrdiff_t>(index), symbol);
+		frequencies.insert(frequencies.begin() + static_cast<std::ptrdiff_t>(index), 1);
+	}
+	total++;
+}
+
+
+uint32_t SparseFrequencyTable::getTotal() const {
+	return total;
+}
+
+
+uint32_t SparseFrequencyTable::getLow(uint32_t symbol) const {
+	std::size_t end = find(symbol);
+	uint32_t result = 0;
+	for (std::size_t i = 0; i < end; i++)
+		result += frequencies[i];
+	return result;
+}
+
+
+uint32_t SparseFrequencyTable::getHigh(uint32_t symbol) const {
+	return getLow(symbol) + get(symbol);
+}
+
+
+uint32_t SparseFrequencyTable::getSymbol(uint32_t value) const {
+	if (value >= total)
+		throw std::domain_error("Value out of range");
+	for (std::size_t i = 0; ; i++) {
+		if (value < frequencies[i])
+			return symbols[i];
+		value -= frequencies[i];
+	}
+}
+
+
+std::size_t SparseFrequencyTable::find(uint32_t symbol) const {
+	if (symbol >= numSymbols)
+		throw std::domain_error("Symbol out of range");
+	return static_cast<std::size_t>(std::lower_bound(symbols.begin(), symbols.end(), symbol) - symbols.begin());
+}
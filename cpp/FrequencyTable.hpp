@@ -8,6 +8,7 @@
 
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 #include <vector>
 
@@ -161,3 +162,190 @@ class SimpleFrequencyTable final : public FrequencyTable {
 	private: static std::uint32_t checkedAdd(std::uint32_t x, std::uint32_t y);
 	
 };
+
+
+
+/* 
+ * An immutable table of symbol frequencies with a small total, which additionally maps every value in
+ * [0, total) directly to the symbol whose cumulative range contains it. ArithmeticDecoder uses this to
+ * find a decoded symbol with one lookup instead of a binary search over the cumulative frequencies.
+ * The lookup array has one entry per unit of the total, so the total is limited to MAX_TOTAL.
+ */
+class LookupFrequencyTable final : public FrequencyTable {
+	
+	/*---- Constants ----*/
+	
+	public: static constexpr std::uint32_t MAX_TOTAL = UINT32_C(1) << 16;
+	
+	
+	/*---- Fields ----*/
+	
+	// cumulative[i] is the sum of the frequencies of the symbols before i. Its length is at least 2.
+	private: std::vector<std::uint32_t> cumulative;
+	
+	// symbols[v] is the symbol s such that cumulative[s] <= v < cumulative[s + 1].
+	private: std::vector<std::uint16_t> symbols;
+	
+	
+	/*---- Constructor ----*/
+	
+	// Constructs a lookup table by copying the given frequency table, which must have at most
+	// 65536 symbols and a total in the range [1, MAX_TOTAL].
+	public: explicit LookupFrequencyTable(const FrequencyTable &freqs);
+	
+	
+	/*---- Methods ----*/
+	
+	public: std::uint32_t getSymbolLimit() const override;
+	
+	
+	public: std::uint32_t get(std::uint32_t symbol) const override;
+	
+	
+	public: std::uint32_t getTotal() const override;
+	
+	
+	public: std::uint32_t getLow(std::uint32_t symbol) const override;
+	
+	
+	public: std::uint32_t getHigh(std::uint32_t symbol) const override;
+	
+	
+	public: void set(std::uint32_t symbol, std::uint32_t freq) override;
+	
+	
+	public: void increment(std::uint32_t symbol) override;
+	
+	
+	// Returns the symbol whose range [getLow(symbol), getHigh(symbol)) contains the given value,
+	// which must be less than the total.
+	public: std::uint32_t getSymbol(std::uint32_t value) const;
+	
+};
+
+
+
+/* 
+ * A mutable table of symbol frequencies for large alphabets, which keeps the cumulative frequencies in a
+ * Fenwick tree (binary indexed tree). Getting a cumulative frequency, changing a frequency, and finding the
+ * symbol that contains a cumulative value all take O(log n) time for n symbols, instead of the O(n) time
+ * that SimpleFrequencyTable takes to recompute its cumulative array after each change. This suits adaptive
+ * models of alphabets like 16-bit symbols, where every symbol needs a frequency.
+ */
+class FenwickFrequencyTable final : public FrequencyTable {
+	
+	/*---- Fields ----*/
+	
+	// The frequency for each symbol. Its length is at least 1.
+	private: std::vector<std::uint32_t> frequencies;
+	
+	// tree[i] (for 1 <= i <= n) is the sum of the frequencies of the symbols in [i - (i & -i), i),
+	// where i & -i is the lowest set bit of i. tree[0] is unused.
+	private: std::vector<std::uint32_t> tree;
+	
+	// Always equal to the sum of 'frequencies'.
+	private: std::uint32_t total;
+	
+	
+	/*---- Constructor ----*/
+	
+	// Constructs a frequency table by copying the given frequency table.
+	public: explicit FenwickFrequencyTable(const FrequencyTable &freqs);
+	
+	
+	/*---- Methods ----*/
+	
+	public: std::uint32_t getSymbolLimit() const override;
+	
+	
+	public: std::uint32_t get(std::uint32_t symbol) const override;
+	
+	
+	public: void set(std::uint32_t symbol, std::uint32_t freq) override;
+	
+	
+	public: void increment(std::uint32_t symbol) override;
+	
+	
+	public: std::uint32_t getTotal() const override;
+	
+	
+	public: std::uint32_t getLow(std::uint32_t symbol) const override;
+	
+	
+	public: std::uint32_t getHigh(std::uint32_t symbol) const override;
+	
+	
+	// Returns the symbol whose range [getLow(symbol), getHigh(symbol)) contains the given value,
+	// which must be less than the total, by descending the tree in O(log n) steps.
+	public: std::uint32_t getSymbol(std::uint32_t value) const;
+	
+	
+	// Adds the given difference (modulo 2^32) to the tree entries that cover the given symbol.
+	private: void addToTree(std::uint32_t symbol, std::uint32_t delta);
+	
+};
+
+
+
+/* 
+ * A mutable table of symbol frequencies that stores only the symbols with a non-zero frequency, in
+ * increasing order, so its size depends on how many distinct symbols were seen rather than on the
+ * alphabet. This suits the many contexts of a high-order model over a large alphabet, each of which
+ * sees a few symbols. Getting a frequency takes O(log k) time for k stored symbols, while cumulative
+ * frequencies, symbol lookups and adding a new symbol take O(k) time.
+ */
+class SparseFrequencyTable final : public FrequencyTable {
+	
+	/*---- Fields ----*/
+	
+	// Total number of symbols in the alphabet, which is at least 1.
+	private: std::uint32_t numSymbols;
+	
+	// The symbols that have an entry, in increasing order, and their frequencies.
+	// Setting a frequency to 0 removes the entry.
+	private: std::vector<std::uint32_t> symbols;
+	private: std::vector<std::uint32_t> frequencies;
+	
+	// Always equal to the sum of 'frequencies'.
+	private: std::uint32_t total;
+	
+	
+	/*---- Constructor ----*/
+	
+	// Constructs a frequency table of the given number of symbols, all with frequency 0.
+	public: explicit SparseFrequencyTable(std::uint32_t numSyms);
+	
+	
+	/*---- Methods ----*/
+	
+	public: std::uint32_t getSymbolLimit() const override;
+	
+	
+	public: std::uint32_t get(std::uint32_t symbol) const override;
+	
+	
+	public: void set(std::uint32_t symbol, std::uint32_t freq) override;
+	
+	
+	public: void increment(std::uint32_t symbol) override;
+	
+	
+	public: std::uint32_t getTotal() const override;
+	
+	
+	public: std::uint32_t getLow(std::uint32_t symbol) const override;
+	
+	
+	public: std::uint32_t getHigh(std::uint32_t symbol) const override;
+	
+	
+	// Returns the symbol whose range [getLow(symbol), getHigh(symbol)) contains the given value,
+	// which must be less than the total, by scanning the stored symbols.
+	public: std::uint32_t getSymbol(std::uint32_t value) const;
+	
+	
+	// Returns the index of the first entry whose symbol is not less than the given symbol.
+	private: std::size_t find(std::uint32_t symbol) const;
+	
+};
@@ -0,0 +1,106 @@
+/* 
+ * Reference arithmetic coding
+ * Copyright (c) Project Nayuki
+ * 
+ * https://www.nayuki.io/page/reference-arithmetic-coding
+ * https://github.com/nayuki/Reference-arithmetic-coding
+ */
+
+#include <algorithm>
+#include <stdexcept>
+#include "IntegerModel.hpp"
+
+using std::uint32_t;
+using std::uint64_t;
+
+
+// The number of bits of a class in its bit tree, enough for classes 0 to 64.
+static constexpr int CLASS_BITS = 7;
+
+
+IntegerModel::IntegerModel(bool useDelta, bool useZigzag, int adaptiveBits) :
+		delta(useDelta),
+		zigzag(useZigzag),
+		adaptiveMantissaBits(adaptiveBits),
+		previous(0),
+		classModel(CLASS_BITS) {
+	if (adaptiveBits < 0 || adaptiveBits > 16)
+		throw std::domain_error("Number of adaptive mantissa bits out of range");
+	if (adaptiveBits > 0) {
+		for (int cls = 2; cls < NUM_CLASSES; cls++)
+			mantissaModels.push_back(BitTreeModel(std::min(cls - 1, adaptiveBits)));
+	}
+}
+
+
+void IntegerModel::encode(ArithmeticEncoder &enc, uint64_t value) {
+	uint64_t coded = transform(value);
+	int cls = getClass(coded);
+	classModel.encodeSymbol(enc, static_cast<uint32_t>(cls));
+	if (cls >= 2) {
+		// Mantissa bits below the leading 1, the top ones adaptively and the rest verbatim
+		int remaining = cls - 1;
+		int adaptive = std::min(remaining, adaptiveMantissaBits);
+		remaining -= adaptive;
+		if (adaptive > 0)
+			mantissaModels.at(cls - 2).encodeSymbol(enc, static_cast<uint32_t>((coded >> remaining) & ((UINT64_C(1) << adaptive) - 1)));
+		if (remaining > 32) {
+			enc.writeBits(static_cast<uint32_t>((coded >> 32) & ((UINT64_C(1) << (remaining - 32)) - 1)), remaining - 32);
+			remaining = 32;
+		}
+		enc.writeBits(static_cast<uint32_t>(coded & ((UINT64_C(1) << remaining) - 1)), remaining);
+	}
+	previous = value;
+}
+
+
+uint64_t IntegerModel::decode(ArithmeticDecoder &dec) {
+	uint32_t cls = classModel.decodeSymbol(dec);
+	if (cls >= static_cast<uint32_t>(NUM_CLASSES))
+		throw std::runtime_error("Invalid integer class in compressed data");
+	uint64_t coded = cls == 0 ? 0 : 1;
+	if (cls >= 2) {
+		int remaining = static_cast<int>(cls) - 1;
+		int adaptive = std::min(remaining, adaptiveMantissaBits);
+		remaining -= adaptive;
+		if (adaptive > 0)
+			coded = coded << adaptive | mantissaModels.at(cls - 2).decodeSymbol(dec);
+		if (remaining > 32) {
+			coded = coded << (remaining - 32) | dec.readBits(remaining - 32);
+			remaining = 32;
+		}
+		coded = coded << remaining | dec.readBits(remaining);
+	}
+	uint64_t value = untransform(coded);
+	previous = value;
+	return value;
+}
+
+
+uint64_t IntegerModel::transform(uint64_t value) const {
+	uint64_t result = delta ? value - previous : value;
+	if (zigzag)
+		result = (result << 1) ^ (0 - (result >> 63));  // Same as (x << 1) ^ (x >> 63) with an arithmetic shift
+	return result;
+}
+
+
+uint64_t IntegerModel::untransform(uint64_t coded) const {
+	uint64_t result = coded;
+	if (zigzag)
+		result = (result >> 1) ^ (0 - (result & 1));
+	return delta ? result + previous : result;
+}
+
+
+int IntegerModel::getClass(uint64_t value) {
+	// Binary search for the highest 1 bit
+	int result = 0;
+	for (int step = 32; step > 0; step >>= 1) {
+		if (value >> step != 0) {
+			value >>= step;
+			result += step;
+		}
+	}
+	return result + static_cast<int>(value);  // The remaining value is 0 or 1
+}
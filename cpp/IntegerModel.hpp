@@ -0,0 +1,85 @@
+/* 
+ * Reference arithmetic coding
+ * Copyright (c) Project Nayuki
+ * 
+ * https://www.nayuki.io/page/reference-arithmetic-coding
+ * https://github.com/nayuki/Reference-arithmetic-coding
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "ArithmeticCoder.hpp"
+#include "BitTreeModel.hpp"
+
+
+/* 
+ * An adaptive model of a sequence of unsigned integers of up to 64 bits, such as a column of numbers, which codes
+ * each value in a handful of binary decisions instead of as bytes. Like Elias gamma coding, a value is split into
+ * its class - its bit length, from 0 for the value 0 up to 64 - and the mantissa bits below its leading 1. The
+ * class is coded with an adaptive BitTreeModel, so typical magnitudes become cheap. The top mantissa bits (up to a
+ * configurable number) are coded with an adaptive BitTreeModel for each class, which captures skew within a class,
+ * and the rest as equiprobable bits (ArithmeticEncoder::writeBits()), which cost exactly one bit each.
+ * Optionally, each value is first replaced by its difference from the previous value (delta), which suits sorted
+ * or slowly changing columns, and the result is zigzag-mapped (0, -1, 1, -2, ... become 0, 1, 2, 3, ...) so that
+ * small negative numbers get small codes. The encoder and decoder must be constructed with the same options.
+ */
+class IntegerModel final {
+	
+	/*---- Constants ----*/
+	
+	// The number of possible classes, which are the bit lengths 0 to 64.
+	public: static constexpr int NUM_CLASSES = 65;
+	
+	
+	/*---- Fields ----*/
+	
+	private: bool delta;
+	private: bool zigzag;
+	private: int adaptiveMantissaBits;
+	
+	// The value last coded, before any transformation, which deltas are taken from. Starts at 0.
+	private: std::uint64_t previous;
+	
+	// Codes the class of each value.
+	private: BitTreeModel classModel;
+	
+	// Element i codes the top mantissa bits of class i + 2 (classes 0 and 1 have no mantissa
+	// bits). Empty if adaptiveMantissaBits is 0.
+	private: std::vector<BitTreeModel> mantissaModels;
+	
+	
+	/*---- Constructor ----*/
+	
+	// Constructs a model that codes deltas if the first flag is true and zigzag-maps the values if the second is
+	// true, and codes up to the given number of top mantissa bits adaptively, which must be in the range [0, 16].
+	// With zigzag, a signed value must be passed as static_cast<std::uint64_t>(static_cast<std::int64_t>(x)), so a
+	// negative 32-bit value is sign-extended. Without zigzag, deltas wrap modulo 2^64, which suits increasing values.
+	// The classes and adaptive mantissa bits are coded as binary decisions (see ArithmeticEncoder::writeBit()), which
+	// need a coder of 14 to 51 state bits (such as the usual 32); with any other size, encode() and decode() throw.
+	public: explicit IntegerModel(bool useDelta, bool useZigzag, int adaptiveBits);
+	
+	
+	/*---- Methods ----*/
+	
+	// Encodes the given value and then adapts the model.
+	public: void encode(ArithmeticEncoder &enc, std::uint64_t value);
+	
+	
+	// Decodes and returns the next value, adapting the model like encode().
+	public: std::uint64_t decode(ArithmeticDecoder &dec);
+	
+	
+	// Returns the value to code for the given input value, according to the options.
+	private: std::uint64_t transform(std::uint64_t value) const;
+	
+	
+	// Returns the input value for the given coded value, undoing transform().
+	private: std::uint64_t untransform(std::uint64_t coded) const;
+	
+	
+	// Returns the bit length of the given value, which is 0 for the value 0.
+	private: static int getClass(std::uint64_t value);
+	
+};
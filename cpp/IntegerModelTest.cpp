@@ -0,0 +1,193 @@
+/* 
+ * Round-trip tests for IntegerModel
+ * 
+ * Usage: IntegerModelTest
+ * This codes sequences of edge-case and random 64-bit values with every combination of the delta and zigzag
+ * options and several numbers of adaptive mantissa bits, and checks that they decode to the same values.
+ * It also checks which arithmetic coder state sizes the model works with. The exit status is zero if every
+ * test passes.
+ * 
+ * Copyright (c) Project Nayuki
+ * 
+ * https://www.nayuki.io/page/reference-arithmetic-coding
+ * https://github.com/nayuki/Reference-arithmetic-coding
+ */
+
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "ArithmeticCoder.hpp"
+#include "BitIoStream.hpp"
+#include "IntegerModel.hpp"
+
+using std::int64_t;
+using std::uint64_t;
+using std::vector;
+
+
+static void testUnsignedEdgeCases();
+static void testSignedEdgeCases();
+static void testRandomValues();
+static void testCompression();
+static void testStateSizes();
+static void testAllOptions(const vector<uint64_t> &values);
+static std::string encode(const vector<uint64_t> &values, bool delta, bool zigzag, int adaptiveBits, int stateBits=32);
+static void checkDecode(const std::string &data, const vector<uint64_t> &values, bool delta, bool zigzag, int adaptiveBits, int stateBits=32);
+static uint64_t fromSigned(int64_t x);
+static void check(bool cond, const std::string &msg);
+
+
+static const int ADAPTIVE_BITS[] = {0, 1, 5, 16};
+
+
+int main() {
+	try {
+		testUnsignedEdgeCases();
+		testSignedEdgeCases();
+		testRandomValues();
+		testCompression();
+		testStateSizes();
+		std::cerr << "Test passed" << std::endl;
+		return EXIT_SUCCESS;
+	} catch (const std::exception &e) {
+		std::cerr << "Test failed: " << e.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+}
+
+
+// Values at the boundaries of the classes and of the 32-bit pieces of the verbatim mantissa bits.
+static void testUnsignedEdgeCases() {
+	const uint64_t TWO_32 = UINT64_C(1) << 32;
+	const uint64_t TWO_63 = UINT64_C(1) << 63;
+	const uint64_t MAX = std::numeric_limits<uint64_t>::max();
+	vector<uint64_t> values{0, 1, 2, 3, TWO_32 - 1, TWO_32, TWO_32 + 1, TWO_63 - 1, TWO_63, TWO_63 + 1, MAX - 1, MAX, 0, MAX, 1, TWO_63, 0};
+	testAllOptions(values);
+	for (int i = 0; i < 64; i++) {  // Every class, at both ends
+		values.push_back(UINT64_C(1) << i);
+		values.push_back((UINT64_C(2) << i) - 1);
+	}
+	testAllOptions(values);
+}
+
+
+// Signed extremes, whose zigzag codes and deltas are at or near the ends of the unsigned range.
+static void testSignedEdgeCases() {
+	const int64_t MIN = std::numeric_limits<int64_t>::min();
+	const int64_t MAX = std::numeric_limits<int64_t>::max();
+	const int64_t MIN32 = std::numeric_limits<std::int32_t>::min();
+	const int64_t MAX32 = std::numeric_limits<std::int32_t>::max();
+	vector<uint64_t> values;
+	for (int64_t x : {INT64_C(0), INT64_C(-1), INT64_C(1), INT64_C(-2), MIN, MAX, MIN, MIN + 1, MAX - 1, MAX, MIN32, MAX32, MIN32 - 1, MAX32 + 1, INT64_C(-1), MIN})
+		values.push_back(fromSigned(x));
+	testAllOptions(values);
+
+	// Zigzag maps 0, -1, 1, -2, ... to 0, 1, 2, 3, ..., so the extremes take the two largest codes
+	std::string minCoded = encode({fromSigned(MIN)}, false, true, 0);
+	std::string maxCoded = encode({fromSigned(MAX)}, false, true, 0);
+	check(minCoded == encode({std::numeric_limits<uint64_t>::max()}, false, false, 0), "Zigzag code of the minimum mismatch");
+	check(maxCoded == encode({std::numeric_limits<uint64_t>::max() - 1}, false, false, 0), "Zigzag code of the maximum mismatch");
+}
+
+
+static void testRandomValues() {
+	std::mt19937_64 random(1);
+	for (int trial = 0; trial < 20; trial++) {
+		vector<uint64_t> values;
+		for (int i = 0; i < 300; i++) {
+			uint64_t x = random();
+			int shift = static_cast<int>(random() % 64);
+			values.push_back(trial % 2 == 0 ? x >> shift : fromSigned(static_cast<int64_t>(x) >> shift));
+		}
+		testAllOptions(values);
+	}
+}
+
+
+// The options must make their intended kinds of data cheap.
+static void testCompression() {
+	vector<uint64_t> increasing;
+	vector<uint64_t> smallSigned;
+	std::mt19937_64 random(2);
+	uint64_t timestamp = UINT64_C(1700000000000);
+	for (int i = 0; i < 10000; i++) {
+		timestamp += 1000 + random() % 16;
+		increasing.push_back(timestamp);
+		smallSigned.push_back(fromSigned(static_cast<int64_t>(random() % 7) - 3));
+	}
+	// A delta of 1000 to 1015 has 10 bits, of which the top 5 are nearly constant, so under a byte each
+	check(encode(increasing, true, false, 5).size() < increasing.size(), "Delta coding too large");
+	// Values -3 to 3 have 7 equally likely codes under zigzag, so about 3 bits each
+	check(encode(smallSigned, false, true, 5).size() < smallSigned.size() * 4 / 8, "Zigzag coding too large");
+	check(encode(smallSigned, false, false, 5).size() > smallSigned.size() * 2, "Sign-extended values unexpectedly cheap");
+}
+
+
+// The model codes binary decisions, which need 14 to 51 coder state bits.
+static void testStateSizes() {
+	vector<uint64_t> values{0, 1, 1000, std::numeric_limits<uint64_t>::max(), UINT64_C(1) << 40};
+	for (int stateBits : {14, 16, 32, 48, 51}) {
+		std::string data = encode(values, true, true, 5, stateBits);
+		checkDecode(data, values, true, true, 5, stateBits);
+	}
+	for (int stateBits : {8, 13, 52, 62, 63}) {
+		bool thrown = false;
+		try {
+			encode(values, false, false, 0, stateBits);
+		} catch (const std::invalid_argument &) {
+			thrown = true;
+		}
+		check(thrown, "Unsupported state size accepted");
+	}
+}
+
+
+static void testAllOptions(const vector<uint64_t> &values) {
+	for (int i = 0; i < 4; i++) {
+		bool delta = (i & 1) != 0;
+		bool zigzag = (i & 2) != 0;
+		for (int adaptiveBits : ADAPTIVE_BITS)
+			checkDecode(encode(values, delta, zigzag, adaptiveBits), values, delta, zigzag, adaptiveBits);
+	}
+}
+
+
+static std::string encode(const vector<uint64_t> &values, bool delta, bool zigzag, int adaptiveBits, int stateBits) {
+	std::ostringstream out;
+	BitOutputStream bout(out);
+	ArithmeticEncoder enc(stateBits, bout);
+	IntegerModel model(delta, zigzag, adaptiveBits);
+	for (uint64_t x : values)
+		model.encode(enc, x);
+	enc.finish();
+	bout.finish();
+	return out.str();
+}
+
+
+static void checkDecode(const std::string &data, const vector<uint64_t> &values, bool delta, bool zigzag, int adaptiveBits, int stateBits) {
+	std::istringstream in(data);
+	BitInputStream bin(in);
+	ArithmeticDecoder dec(stateBits, bin);
+	IntegerModel model(delta, zigzag, adaptiveBits);
+	for (uint64_t x : values)
+		check(model.decode(dec) == x, "Decoded value mismatch");
+}
+
+
+// Returns the given signed value in the form that IntegerModel takes with zigzag.
+static uint64_t fromSigned(int64_t x) {
+	return static_cast<uint64_t>(x);
+}
+
+
+static void check(bool cond, const std::string &msg) {
+	if (!cond)
+		throw std::logic_error(msg);
+}
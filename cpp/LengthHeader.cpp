@@ -0,0 +1,55 @@
+/* 
+ * Reference arithmetic coding
+ * Copyright (c) Project Nayuki
+ * 
+ * https://www.nayuki.io/page/reference-arithmetic-coding
+ * https://github.com/nayuki/Reference-arithmetic-coding
+ */
+
+#include <stdexcept>
+#include "LengthHeader.hpp"
+
+using std::uint64_t;
+
+
+void LengthHeader::write(uint64_t length, BitOutputStream &out) {
+	if (length > MAX_LENGTH)
+		throw std::domain_error("Length too large");
+	uint64_t val = length + 1;
+	int n = 0;
+	while ((val >> n) > 1)
+		n++;
+	for (int i = 0; i < n; i++)
+		out.write(0);
+	for (int i = n; i >= 0; i--)
+		out.write(static_cast<int>((val >> i) & 1));
+}
+
+
+uint64_t LengthHeader::read(BitInputStream &in) {
+	int n = 0;
+	while (in.readNoEof() == 0) {
+		n++;
+		if ((UINT64_C(1) << n) - 1 > MAX_LENGTH)
+			throw std::runtime_error("Length header too large");
+	}
+	uint64_t result = 1;
+	for (int i = 0; i < n; i++)
+		result = (result << 1) | static_cast<uint64_t>(in.readNoEof());
+	if (result - 1 > MAX_LENGTH)
+		throw std::runtime_error("Length header too large");
+	return result - 1;
+}
+
+
+uint64_t LengthHeader::getRemainingLength(std::istream &in) {
+	std::streampos start = in.tellg();
+	if (start == std::streampos(-1))
+		throw std::runtime_error("--length-prefix needs a seekable input");
+	in.seekg(0, std::ios_base::end);
+	std::streampos end = in.tellg();
+	in.seekg(start);
+	if (!in || end < start)
+		throw std::runtime_error("Cannot seek in input");
+	return static_cast<uint64_t>(end - start);
+}
@@ -0,0 +1,50 @@
+/* 
+ * Reference arithmetic coding
+ * Copyright (c) Project Nayuki
+ * 
+ * https://www.nayuki.io/page/reference-arithmetic-coding
+ * https://github.com/nayuki/Reference-arithmetic-coding
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <istream>
+#include "BitIoStream.hpp"
+
+
+/* 
+ * The uncompressed length that precedes the coded data when an application is given --length-prefix.
+ * The decoder then decodes exactly that many symbols, so the models have no EOF symbol: the byte
+ * alphabet is 256 symbols instead of 257, and the decoding loop has no per-symbol EOF test. The length
+ * is written as the Elias gamma code of length + 1, which takes 1 bit for an empty input and 2*n + 1
+ * bits for a length below 2^n (for example 41 bits for a length below 1 MiB). Because the compressor
+ * must know the length before coding anything, it needs a seekable input (or one held in memory).
+ * The coded data after the header ends with ArithmeticEncoder::flush() instead of finish(), which costs
+ * a few more bytes but lets the decoder reject truncated data instead of decoding padding as symbols.
+ */
+class LengthHeader final {
+	
+	/*---- Constants ----*/
+	
+	// The largest length that can be written, which is far more than any input of these tools
+	// but keeps a damaged header from making the decoder produce up to 2^64 bytes.
+	public: static constexpr std::uint64_t MAX_LENGTH = UINT64_C(1) << 40;
+	
+	
+	/*---- Methods ----*/
+	
+	// Writes the given length, which must be at most MAX_LENGTH, to the given stream.
+	public: static void write(std::uint64_t length, BitOutputStream &out);
+	
+	
+	// Reads and returns a length written by write(). Throws an exception if the data is malformed,
+	// the length exceeds MAX_LENGTH, or the data ends early.
+	public: static std::uint64_t read(BitInputStream &in);
+	
+	
+	// Returns the number of bytes from the given stream's current position to its end, leaving the position
+	// unchanged. Throws an exception if the stream doesn't support seeking, such as a pipe.
+	public: static std::uint64_t getRemainingLength(std::istream &in);
+	
+};
@@ -0,0 +1,145 @@
+/* 
+ * Reference arithmetic coding
+ * Copyright (c) Project Nayuki
+ * 
+ * https://www.nayuki.io/page/reference-arithmetic-coding
+ * https://github.com/nayuki/Reference-arithmetic-coding
+ */
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include "PerfCounters.hpp"
+
+#if defined(__linux__)
+	#include <linux/perf_event.h>
+	#include <sys/ioctl.h>
+	#include <sys/syscall.h>
+	#include <unistd.h>
+	#define PERF_COUNTERS_LINUX 1
+#endif
+
+using std::uint64_t;
+
+
+#if PERF_COUNTERS_LINUX
+
+static int openCounter(PerfCounters::Event event) {
+	struct perf_event_attr attr;
+	std::memset(&attr, 0, sizeof(attr));
+	attr.size = sizeof(attr);
+	attr.disabled = 1;
+	attr.exclude_kernel = 1;
+	attr.exclude_hv = 1;
+	attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+	switch (event) {
+		case PerfCounters::CYCLES:
+			attr.type = PERF_TYPE_HARDWARE;
+			attr.config = PERF_COUNT_HW_CPU_CYCLES;
+			break;
+		case PerfCounters::INSTRUCTIONS:
+			attr.type = PERF_TYPE_HARDWARE;
+			attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+			break;
+		case PerfCounters::BRANCH_MISSES:
+			attr.type = PERF_TYPE_HARDWARE;
+			attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+			break;
+		case PerfCounters::L1D_MISSES:
+			attr.type = PERF_TYPE_HW_CACHE;
+			attr.config = PERF_COUNT_HW_CACHE_L1D
+				| PERF_COUNT_HW_CACHE_OP_READ << 8
+				| PERF_COUNT_HW_CACHE_RESULT_MISS << 16;
+			break;
+		case PerfCounters::LLC_MISSES:
+			attr.type = PERF_TYPE_HARDWARE;
+			attr.config = PERF_COUNT_HW_CACHE_MISSES;
+			break;
+		default:
+			throw std::logic_error("Assertion error");
+	}
+	// This thread, any CPU, no group, no flags
+	return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+}
+
+#endif
+
+
+PerfCounters::PerfCounters() {
+	for (int i = 0; i < NUM_EVENTS; i++) {
+		#if PERF_COUNTERS_LINUX
+			fds[i] = openCounter(static_cast<Event>(i));
+		#else
+			fds[i] = -1;
+		#endif
+		values[i] = -1;
+	}
+}
+
+
+PerfCounters::~PerfCounters() {
+	#if PERF_COUNTERS_LINUX
+		for (int fd : fds) {
+			if (fd != -1)
+				close(fd);
+		}
+	#endif
+}
+
+
+bool PerfCounters::isAnyAvailable() const {
+	for (int fd : fds) {
+		if (fd != -1)
+			return true;
+	}
+	return false;
+}
+
+
+void PerfCounters::start() {
+	#if PERF_COUNTERS_LINUX
+		for (int fd : fds) {
+			if (fd != -1) {
+				ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+				ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+			}
+		}
+	#endif
+}
+
+
+void PerfCounters::stop() {
+	for (int i = 0; i < NUM_EVENTS; i++) {
+		values[i] = -1;
+		#if PERF_COUNTERS_LINUX
+			if (fds[i] == -1)
+				continue;
+			ioctl(fds[i], PERF_EVENT_IOC_DISABLE, 0);
+			uint64_t data[3];  // Value, time enabled, time running
+			if (read(fds[i], data, sizeof(data)) != static_cast<ssize_t>(sizeof(data)) || data[2] == 0)
+				continue;
+			values[i] = static_cast<double>(data[0]);
+			if (data[2] < data[1])
+				values[i] *= static_cast<double>(data[1]) / data[2];
+		#endif
+	}
+}
+
+
+double PerfCounters::get(Event event) const {
+	if (event < 0 || event >= NUM_EVENTS)
+		throw std::domain_error("Invalid event");
+	return values[event];
+}
+
+
+const char *PerfCounters::getName(Event event) {
+	switch (event) {
+		case CYCLES       :  return "cycles";
+		case INSTRUCTIONS :  return "instructions";
+		case BRANCH_MISSES:  return "branch-misses";
+		case L1D_MISSES   :  return "L1d-misses";
+		case LLC_MISSES   :  return "LLC-misses";
+		default:  throw std::domain_error("Invalid event");
+	}
+}
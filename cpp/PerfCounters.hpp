@@ -0,0 +1,79 @@
+/* 
+ * Reference arithmetic coding
+ * Copyright (c) Project Nayuki
+ * 
+ * https://www.nayuki.io/page/reference-arithmetic-coding
+ * https://github.com/nayuki/Reference-arithmetic-coding
+ */
+
+#pragma once
+
+#include <cstdint>
+
+
+/* 
+ * A set of hardware performance counters for the calling thread, read through the Linux
+ * perf_event_open() system call. Only user-space events are counted. Each counter is opened
+ * separately, so a counter that the CPU, kernel, or permission settings don't provide (e.g. in
+ * a virtual machine, or when kernel.perf_event_paranoid is too high) is simply unavailable while
+ * the others still work. On other operating systems every counter is unavailable.
+ */
+class PerfCounters final {
+	
+	/*---- Constants ----*/
+	
+	public: enum Event {
+		CYCLES,
+		INSTRUCTIONS,
+		BRANCH_MISSES,
+		L1D_MISSES,
+		LLC_MISSES,
+		NUM_EVENTS,
+	};
+	
+	
+	/*---- Fields ----*/
+	
+	// File descriptor of each event's counter, or -1 if it is unavailable.
+	private: int fds[NUM_EVENTS];
+	
+	// Each event's count from the most recent start()/stop() interval, or -1 if unknown.
+	private: double values[NUM_EVENTS];
+	
+	
+	/*---- Constructor ----*/
+	
+	// Opens the counters for the calling thread. Never throws an exception because a counter is missing.
+	public: explicit PerfCounters();
+	
+	
+	public: ~PerfCounters();
+	
+	
+	public: PerfCounters(const PerfCounters &) = delete;
+	public: PerfCounters &operator=(const PerfCounters &) = delete;
+	
+	
+	/*---- Methods ----*/
+	
+	// Returns whether at least one counter is available.
+	public: bool isAnyAvailable() const;
+	
+	
+	// Resets and starts all available counters.
+	public: void start();
+	
+	
+	// Stops all counters and records their values.
+	public: void stop();
+	
+	
+	// Returns the given event's count between the last start() and stop(), or -1 if the counter is unavailable.
+	// If the kernel had to multiplex the counters, the value is scaled up to estimate the full interval.
+	public: double get(Event event) const;
+	
+	
+	// Returns a short lowercase name for the given event, such as "cycles".
+	public: static const char *getName(Event event);
+	
+};
@@ -1,10 +1,23 @@
 /* 
  * Compression application using prediction by partial matching (PPM) with arithmetic coding
  * 
- * Usage: PpmCompress InputFile OutputFile
+ * Usage: PpmCompress [--stats] [--symbol-bits=8|16] [--length-prefix] [--blocks [--block-size=N] [--threads=N] [--auto-model]] InputFile OutputFile
+ * Either file name can be "-" to read from standard input or write to standard output.
  * Then use the corresponding "PpmDecompress" application to recreate the original input file.
  * Note that both the compressor and decompressor need to use the same PPM context modeling logic.
  * The PPM algorithm can be thought of as a powerful generalization of adaptive arithmetic coding.
+ * With --blocks, the input is split into blocks of N bytes (default 1 MiB) that are compressed
+ * independently on N worker threads, and the output is a block container (see BlockContainer.hpp).
+ * With --auto-model, each block is coded with whichever model (stored, static of order 0 or 1, adaptive
+ * binary, adaptive, or PPM of order 1 to 3) is estimated to suit it best instead of this application's model.
+ * With --symbol-bits=16, the input is coded as little-endian 16-bit symbols (see WideSymbolIo.hpp) with
+ * SparsePpmModel, which stores only the symbols that have occurred in each context, so that its memory
+ * grows with the input rather than the alphabet. This doesn't work with --blocks, whose models code bytes.
+ * The same --symbol-bits must be given to the decompressor.
+ * With --length-prefix, the output starts with the input length (see LengthHeader.hpp) and the model has
+ * no EOF symbol, so the order -1 context codes each byte as 8 equiprobable bits with no end decision.
+ * This needs a seekable input and 8-bit symbols, and the same option must be given to the decompressor.
+ * With --stats, counts of coding events are printed to standard error (see CodingStats.hpp).
  * 
  * Copyright (c) Project Nayuki
  * 
@@ -15,13 +28,21 @@
 #include <cstddef>
 #include <cstdint>
 #include <cstdlib>
-#include <fstream>
 #include <iostream>
 #include <stdexcept>
+#include <string>
 #include <vector>
 #include "ArithmeticCoder.hpp"
 #include "BitIoStream.hpp"
+#include "BlockContainer.hpp"
+#include "CodingStats.hpp"
+#include "CommandLine.hpp"
+#include "FileStream.hpp"
+#include "LengthHeader.hpp"
 #include "PpmModel.hpp"
+#include "SparsePpmModel.hpp"
+#include "ThreadPool.hpp"
+#include "WideSymbolIo.hpp"
 
 using std::uint32_t;
 using std::vector;
@@ -31,35 +52,81 @@ using std::vector;
 static constexpr int MODEL_ORDER = 3;
 
 
-static void compress(std::ifstream &in, BitOutputStream &out);
-static void encodeSymbol(PpmModel &model, const vector<uint32_t> &history, uint32_t symbol, ArithmeticEncoder &enc);
+static void compress(std::istream &in, BitOutputStream &out);
+
+static void compressWide(std::istream &in, BitOutputStream &out);
+
+static void compressWithLength(std::istream &in, BitOutputStream &out);
 
 
 int main(int argc, char *argv[]) {
 	// Handle command line arguments
-	if (argc != 3) {
-		std::cerr << "Usage: " << argv[0] << " InputFile OutputFile" << std::endl;
+	CommandLine cmd(argc, argv);
+	const std::vector<std::string> &args = cmd.getArguments();
+	bool validArgs = args.size() == 2 && cmd.hasOnlyOptions({"stats", "symbol-bits", "length-prefix", "blocks", "block-size", "threads", "auto-model"});
+	unsigned long symbolBits = 8;
+	try {
+		symbolBits = cmd.getNumber("symbol-bits", 8);
+	} catch (const std::exception &e) {
+		std::cerr << e.what() << std::endl;
+		validArgs = false;
+	}
+	if (!validArgs) {
+		std::cerr << "Usage: " << argv[0] << " [--stats] [--symbol-bits=8|16] [--length-prefix] [--blocks [--block-size=N] [--threads=N] [--auto-model]] InputFile OutputFile" << std::endl;
+		return EXIT_FAILURE;
+	}
+	const char *inputFile  = args.at(0).c_str();
+	const char *outputFile = args.at(1).c_str();
+	if ((symbolBits != 8 && symbolBits != 16) || (symbolBits == 16 && cmd.hasOption("blocks"))) {
+		std::cerr << "Symbol bits must be 8 or 16, and 16 is not supported with --blocks" << std::endl;
+		return EXIT_FAILURE;
+	}
+	bool lengthPrefix = cmd.hasOption("length-prefix");
+	if (lengthPrefix && (symbolBits != 8 || cmd.hasOption("blocks"))) {
+		std::cerr << "--length-prefix is only supported with 8-bit symbols and without --blocks" << std::endl;
 		return EXIT_FAILURE;
 	}
-	const char *inputFile  = argv[1];
-	const char *outputFile = argv[2];
 	
 	// Perform file compression
-	std::ifstream in(inputFile, std::ios::binary);
-	std::ofstream out(outputFile, std::ios::binary);
-	BitOutputStream bout(out);
 	try {
-		compress(in, bout);
+		InputFileStream in(inputFile);
+		OutputFileStream out(outputFile);
+		if (cmd.hasOption("blocks")) {
+			// Compress independent blocks on multiple threads into a block container
+			std::size_t blockSize = cmd.getNumber("block-size", BlockCompressor::DEFAULT_BLOCK_SIZE);
+			unsigned int threads = static_cast<unsigned int>(cmd.getNumber("threads", ThreadPool::defaultThreadCount()));
+			BlockCompressor comp = cmd.hasOption("auto-model") ? BlockCompressor(blockSize, threads)
+				: BlockCompressor(BlockModel::PPM, MODEL_ORDER, blockSize, threads);
+			comp.compress(in, out);
+			out.finish();
+			if (cmd.hasOption("stats"))
+				CodingStats::dump(std::cerr);
+			return EXIT_SUCCESS;
+		}
+		
+		BitOutputStream bout(out);
+		if (symbolBits == 16)
+			compressWide(in, bout);
+		else if (lengthPrefix)
+			compressWithLength(in, bout);
+		else
+			compress(in, bout);
 		bout.finish();
+		out.finish();
+		if (cmd.hasOption("stats"))
+			CodingStats::dump(std::cerr);
 		return EXIT_SUCCESS;
 	} catch (const char *msg) {
 		std::cerr << msg << std::endl;
 		return EXIT_FAILURE;
+	} catch (const std::exception &e) {
+		std::cerr << e.what() << std::endl;
+		return EXIT_FAILURE;
 	}
 }
 
 
-static void compress(std::ifstream &in, BitOutputStream &out) {
+static void compress(std::istream &in, BitOutputStream &out) {
 	// Set up encoder and model. In this PPM model, symbol 256 represents EOF;
 	// its frequency is 1 in the order -1 context but its frequency
 	// is 0 in all other contexts (which have non-negative order).
@@ -75,44 +142,61 @@ static void compress(std::ifstream &in, BitOutputStream &out) {
 		if (symbol < 0 || symbol > 255)
 			throw std::logic_error("Assertion error");
 		uint32_t sym = static_cast<uint32_t>(symbol);
-		encodeSymbol(model, history, sym, enc);
+		model.encodeSymbol(enc, history, sym);
 		model.incrementContexts(history, sym);
-		
-		if (model.modelOrder >= 1) {
-			// Prepend current symbol, dropping oldest symbol if necessary
-			if (history.size() >= static_cast<unsigned int>(model.modelOrder))
-				history.erase(history.end() - 1);
-			history.insert(history.begin(), sym);
-		}
+		model.pushHistory(history, sym);
 	}
 	
-	encodeSymbol(model, history, 256, enc);  // EOF
+	model.encodeSymbol(enc, history, 256);  // EOF
 	enc.finish();  // Flush remaining code bits
 }
 
 
-static void encodeSymbol(PpmModel &model, const vector<uint32_t> &history, uint32_t symbol, ArithmeticEncoder &enc) {
-	// Try to use highest order context that exists based on the history suffix, such
-	// that the next symbol has non-zero frequency. When symbol 256 is produced at a context
-	// at any non-negative order, it means "escape to the next lower order with non-empty
-	// context". When symbol 256 is produced at the order -1 context, it means "EOF".
-	for (int order = static_cast<int>(history.size()); order >= 0; order--) {
-		PpmModel::Context *ctx = model.rootContext.get();
-		for (int i = 0; i < order; i++) {
-			if (ctx->subcontexts.empty())
-				throw std::logic_error("Assertion error");
-			ctx = ctx->subcontexts.at(history.at(i)).get();
-			if (ctx == nullptr)
-				goto outerEnd;
-		}
-		if (symbol != 256 && ctx->frequencies.get(symbol) > 0) {
-			enc.write(ctx->frequencies, symbol);
-			return;
-		}
-		// Else write context escape symbol and continue decrementing the order
-		enc.write(ctx->frequencies, 256);
-		outerEnd:;
+static void compressWide(std::istream &in, BitOutputStream &out) {
+	// Like compress(), but over 16-bit symbols, where symbol 65536 represents EOF
+	// and is followed by the trailing byte of an odd-length input
+	ArithmeticEncoder enc(32, out);
+	SparsePpmModel model(MODEL_ORDER, WideSymbolIo::NUM_SYMBOLS + 1, WideSymbolIo::NUM_SYMBOLS);
+	vector<uint32_t> history;
+	int trailingByte;
+	
+	while (true) {
+		// Read and encode one symbol
+		long symbol = WideSymbolIo::readSymbol(in, trailingByte);
+		if (symbol == -1)
+			break;
+		uint32_t sym = static_cast<uint32_t>(symbol);
+		model.encodeSymbol(enc, history, sym);
+		model.incrementContexts(history, sym);
+		model.pushHistory(history, sym);
+	}
+	
+	model.encodeSymbol(enc, history, WideSymbolIo::NUM_SYMBOLS);  // EOF
+	WideSymbolIo::encodeTrailer(enc, trailingByte);
+	enc.finish();  // Flush remaining code bits
+}
+
+
+static void compressWithLength(std::istream &in, BitOutputStream &out) {
+	// Like compress(), but preceded by the length of the rest of the input and with a model
+	// that has no EOF symbol, where symbol 256 is only the escape symbol of each context
+	std::uint64_t length = LengthHeader::getRemainingLength(in);
+	LengthHeader::write(length, out);
+	ArithmeticEncoder enc(32, out);
+	PpmModel model(MODEL_ORDER, 257, 256, false);
+	vector<uint32_t> history;
+	
+	for (std::uint64_t i = 0; i < length; i++) {
+		// Read and encode one byte
+		int symbol = in.get();
+		if (symbol == EOF)
+			throw std::runtime_error("Input ended before its length");
+		if (symbol < 0 || symbol > 255)
+			throw std::logic_error("Assertion error");
+		uint32_t sym = static_cast<uint32_t>(symbol);
+		model.encodeSymbol(enc, history, sym);
+		model.incrementContexts(history, sym);
+		model.pushHistory(history, sym);
 	}
-	// Logic for order = -1
-	enc.write(model.orderMinus1Freqs, symbol);
+	enc.flush();  // End with no bits that the decoder must pad (see LengthHeader.hpp)
 }
@@ -1,8 +1,16 @@
 /* 
  * Decompression application using prediction by partial matching (PPM) with arithmetic coding
  * 
- * Usage: PpmDecompress InputFile OutputFile
+ * Usage: PpmDecompress [--stats] [--symbol-bits=8|16] [--length-prefix] [--blocks [--threads=N] [--offset=N --length=N]] InputFile OutputFile
+ * Either file name can be "-" to read from standard input or write to standard output.
  * This decompresses files generated by the "PpmCompress" application.
+ * With --blocks, the input must be a block container produced by the --blocks mode
+ * of any of the compression applications, since each block records its own model.
+ * The blocks are decoded concurrently on N worker threads. With --offset and --length, only that byte
+ * range of the original data is written, and only the blocks overlapping it are decoded; this needs a
+ * seekable input, and the compressor's block size sets the granularity of the random access.
+ * The same --symbol-bits and --length-prefix must be given as to the compressor.
+ * With --stats, counts of coding events are printed to standard error (see CodingStats.hpp).
  * 
  * Copyright (c) Project Nayuki
  * 
@@ -13,14 +21,22 @@
 #include <cstddef>
 #include <cstdint>
 #include <cstdlib>
-#include <fstream>
 #include <iostream>
 #include <limits>
 #include <stdexcept>
+#include <string>
 #include <vector>
 #include "ArithmeticCoder.hpp"
 #include "BitIoStream.hpp"
+#include "BlockContainer.hpp"
+#include "CodingStats.hpp"
+#include "CommandLine.hpp"
+#include "FileStream.hpp"
+#include "LengthHeader.hpp"
 #include "PpmModel.hpp"
+#include "SparsePpmModel.hpp"
+#include "ThreadPool.hpp"
+#include "WideSymbolIo.hpp"
 
 using std::uint32_t;
 using std::vector;
@@ -31,28 +47,74 @@ static constexpr int MODEL_ORDER = 3;
 
 
 static void decompress(BitInputStream &in, std::ostream &out);
-static uint32_t decodeSymbol(ArithmeticDecoder &dec, PpmModel &model, const vector<uint32_t> &history);
+
+static void decompressWide(BitInputStream &in, std::ostream &out);
+
+static void decompressWithLength(BitInputStream &in, std::ostream &out);
 
 
 int main(int argc, char *argv[]) {
 	// Handle command line arguments
-	if (argc != 3) {
-		std::cerr << "Usage: " << argv[0] << " InputFile OutputFile" << std::endl;
+	CommandLine cmd(argc, argv);
+	const std::vector<std::string> &args = cmd.getArguments();
+	bool validArgs = args.size() == 2 && cmd.hasOnlyOptions({"stats", "symbol-bits", "length-prefix", "blocks", "threads", "offset", "length"})
+			&& cmd.hasOption("offset") == cmd.hasOption("length");
+	unsigned long symbolBits = 8;
+	try {
+		symbolBits = cmd.getNumber("symbol-bits", 8);
+	} catch (const std::exception &e) {
+		std::cerr << e.what() << std::endl;
+		validArgs = false;
+	}
+	if (!validArgs) {
+		std::cerr << "Usage: " << argv[0] << " [--stats] [--symbol-bits=8|16] [--length-prefix] [--blocks [--threads=N] [--offset=N --length=N]] InputFile OutputFile" << std::endl;
+		return EXIT_FAILURE;
+	}
+	const char *inputFile  = args.at(0).c_str();
+	const char *outputFile = args.at(1).c_str();
+	if ((symbolBits != 8 && symbolBits != 16) || (symbolBits == 16 && cmd.hasOption("blocks"))) {
+		std::cerr << "Symbol bits must be 8 or 16, and 16 is not supported with --blocks" << std::endl;
+		return EXIT_FAILURE;
+	}
+	bool lengthPrefix = cmd.hasOption("length-prefix");
+	if (lengthPrefix && (symbolBits != 8 || cmd.hasOption("blocks"))) {
+		std::cerr << "--length-prefix is only supported with 8-bit symbols and without --blocks" << std::endl;
 		return EXIT_FAILURE;
 	}
-	const char *inputFile  = argv[1];
-	const char *outputFile = argv[2];
 	
 	// Perform file decompression
-	std::ifstream in(inputFile, std::ios::binary);
-	std::ofstream out(outputFile, std::ios::binary);
-	BitInputStream bin(in);
 	try {
-		decompress(bin, out);
+		InputFileStream in(inputFile);
+		OutputFileStream out(outputFile);
+		if (cmd.hasOption("blocks")) {
+			BlockDecompressor decomp(static_cast<unsigned int>(cmd.getNumber("threads", ThreadPool::defaultThreadCount())));
+			if (cmd.hasOption("offset"))
+				decomp.decompressRange(in, out, cmd.getNumber("offset", 0), cmd.getNumber("length", 0));
+			else
+				decomp.decompress(in, out);
+			out.finish();
+			if (cmd.hasOption("stats"))
+				CodingStats::dump(std::cerr);
+			return EXIT_SUCCESS;
+		}
+		
+		BitInputStream bin(in);
+		if (symbolBits == 16)
+			decompressWide(bin, out);
+		else if (lengthPrefix)
+			decompressWithLength(bin, out);
+		else
+			decompress(bin, out);
+		out.finish();
+		if (cmd.hasOption("stats"))
+			CodingStats::dump(std::cerr);
 		return EXIT_SUCCESS;
 	} catch (const char *msg) {
 		std::cerr << msg << std::endl;
 		return EXIT_FAILURE;
+	} catch (const std::exception &e) {
+		std::cerr << e.what() << std::endl;
+		return EXIT_FAILURE;
 	}
 }
 
@@ -67,7 +129,7 @@ static void decompress(BitInputStream &in, std::ostream &out) {
 	
 	while (true) {
 		// Decode and write one byte
-		uint32_t symbol = decodeSymbol(dec, model, history);
+		uint32_t symbol = model.decodeSymbol(dec, history);
 		if (symbol == 256)  // EOF symbol
 			break;
 		int b = static_cast<int>(symbol);
@@ -75,38 +137,48 @@ static void decompress(BitInputStream &in, std::ostream &out) {
 			b -= (b >> 7) << 8;
 		out.put(static_cast<char>(b));
 		model.incrementContexts(history, symbol);
-		
-		if (model.modelOrder >= 1) {
-			// Prepend current symbol, dropping oldest symbol if necessary
-			if (history.size() >= static_cast<unsigned int>(model.modelOrder))
-				history.erase(history.end() - 1);
-			history.insert(history.begin(), symbol);
-		}
+		model.pushHistory(history, symbol);
 	}
 }
 
 
-static uint32_t decodeSymbol(ArithmeticDecoder &dec, PpmModel &model, const vector<uint32_t> &history) {
-	// Try to use highest order context that exists based on the history suffix. When symbol 256
-	// is consumed at a context at any non-negative order, it means "escape to the next lower order
-	// with non-empty context". When symbol 256 is consumed at the order -1 context, it means "EOF".
-	for (int order = static_cast<int>(history.size()); order >= 0; order--) {
-		PpmModel::Context *ctx = model.rootContext.get();
-		for (int i = 0; i < order; i++) {
-			if (ctx->subcontexts.empty())
-				throw std::logic_error("Assertion error");
-			ctx = ctx->subcontexts.at(history.at(i)).get();
-			if (ctx == nullptr)
-				goto outerEnd;
-		}
-		{
-			uint32_t symbol = dec.read(ctx->frequencies);
-			if (symbol < 256)
-				return symbol;
-		}
-		// Else we read the context escape symbol, so continue decrementing the order
-		outerEnd:;
+static void decompressWide(BitInputStream &in, std::ostream &out) {
+	// Like decompress(), but over 16-bit symbols, where symbol 65536 represents EOF
+	// and is followed by the trailing byte of an odd-length input
+	ArithmeticDecoder dec(32, in);
+	SparsePpmModel model(MODEL_ORDER, WideSymbolIo::NUM_SYMBOLS + 1, WideSymbolIo::NUM_SYMBOLS);
+	vector<uint32_t> history;
+	
+	while (true) {
+		// Decode and write one symbol
+		uint32_t symbol = model.decodeSymbol(dec, history);
+		if (symbol == WideSymbolIo::NUM_SYMBOLS)  // EOF symbol
+			break;
+		WideSymbolIo::writeSymbol(out, symbol);
+		model.incrementContexts(history, symbol);
+		model.pushHistory(history, symbol);
+	}
+	
+	WideSymbolIo::writeTrailer(out, WideSymbolIo::decodeTrailer(dec));
+}
+
+
+static void decompressWithLength(BitInputStream &in, std::ostream &out) {
+	// Like decompress(), but decodes exactly the number of bytes that the length header
+	// gives, with a model that has no EOF symbol (see compressWithLength() in PpmCompress)
+	std::uint64_t length = LengthHeader::read(in);
+	ArithmeticDecoder dec(32, in, true);
+	PpmModel model(MODEL_ORDER, 257, 256, false);
+	vector<uint32_t> history;
+	
+	for (std::uint64_t i = 0; i < length; i++) {
+		// Decode and write one byte
+		uint32_t symbol = model.decodeSymbol(dec, history);
+		int b = static_cast<int>(symbol);
+		if (std::numeric_limits<char>::is_signed)
+			b -= (b >> 7) << 8;
+		out.put(static_cast<char>(b));
+		model.incrementContexts(history, symbol);
+		model.pushHistory(history, symbol);
 	}
-	// Logic for order = -1
-	return dec.read(model.orderMinus1Freqs);
 }
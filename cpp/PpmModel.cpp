@@ -9,9 +9,11 @@
 #include <algorithm>
 #include <cstddef>
 #include <stdexcept>
+#include "CodingStats.hpp"
 #include "PpmModel.hpp"
 
 using std::uint32_t;
+using std::uint64_t;
 using std::vector;
 
 
@@ -24,17 +26,20 @@ PpmModel::Context::Context(uint32_t symbols, bool hasSubctx) :
 }
 
 
-PpmModel::PpmModel(int order, uint32_t symLimit, uint32_t escapeSym) :
+PpmModel::PpmModel(int order, uint32_t symLimit, uint32_t escapeSym, bool hasEndSym, bool endAsDecision) :
 		modelOrder(order),
 		symbolLimit(symLimit),
 		escapeSymbol(escapeSym),
+		hasEndSymbol(hasEndSym),
 		rootContext(std::unique_ptr<Context>(nullptr)),
-		orderMinus1Freqs(FlatFrequencyTable(symbolLimit)) {
-	if (order < -1 || escapeSym >= symLimit)
+		orderMinus1Freqs(FlatFrequencyTable(hasEndSym || symLimit < 2 ? symLimit : symLimit - 1)),
+		orderMinus1Bits(endAsDecision || !hasEndSym ? getOrderMinus1Bits(symLimit) : -1) {
+	if (order < -1 || escapeSym >= symLimit || (!hasEndSym && symLimit < 2))
 		throw std::domain_error("Illegal argument");
 	if (order >= 0) {
 		rootContext.reset(new Context(symbolLimit, order >= 1));
 		rootContext->frequencies.increment(escapeSymbol);
+		CODING_STATS_ADD(CONTEXTS_CREATED, 1);
 	}
 }
 
@@ -57,9 +62,207 @@ void PpmModel::incrementContexts(const vector<uint32_t> &history, uint32_t symbo
 		if (subctx.get() == nullptr) {
 			subctx.reset(new Context(symbolLimit, i + 1 < static_cast<unsigned int>(modelOrder)));
 			subctx->frequencies.increment(escapeSymbol);
+			CODING_STATS_ADD(CONTEXTS_CREATED, 1);
 		}
 		ctx = subctx.get();
 		ctx->frequencies.increment(symbol);
 		i++;
 	}
 }
+
+
+void PpmModel::encodeSymbol(ArithmeticEncoder &enc, const vector<uint32_t> &history, uint32_t symbol) const {
+	// Try to use highest order context that exists based on the history suffix, such
+	// that the next symbol has non-zero frequency. When the escape symbol is produced at a context
+	// at any non-negative order, it means "escape to the next lower order with non-empty
+	// context". When the escape symbol is produced at the order -1 context, it means "EOF".
+	CodingCostMeter *meter = enc.getCostMeter();
+	for (int order = modelOrder == -1 ? -1 : static_cast<int>(history.size()); order >= 0; order--) {
+		Context *ctx = rootContext.get();
+		for (int i = 0; i < order; i++) {
+			if (ctx->subcontexts.empty())
+				throw std::logic_error("Assertion error");
+			ctx = ctx->subcontexts.at(history.at(i)).get();
+			if (ctx == nullptr)
+				goto outerEnd;
+		}
+		if (symbol != escapeSymbol && ctx->frequencies.get(symbol) > 0) {
+			if (meter != nullptr)
+				meter->setCategory(order, CodingCostMeter::SYMBOL);
+			enc.write(ctx->frequencies, symbol);
+			return;
+		}
+		// Else write context escape symbol and continue decrementing the order
+		if (meter != nullptr)
+			meter->setCategory(order, CodingCostMeter::ESCAPE);
+		enc.write(ctx->frequencies, escapeSymbol);
+		CODING_STATS_ESCAPE(order);
+		outerEnd:;
+	}
+	// Logic for order = -1
+	if (meter != nullptr)
+		meter->setCategory(-1, symbol == escapeSymbol ? CodingCostMeter::END_OF_DATA : CodingCostMeter::SYMBOL);
+	if (!hasEndSymbol) {
+		if (symbol == escapeSymbol)
+			throw std::invalid_argument("Model has no end symbol");
+		uint32_t index = symbol < escapeSymbol ? symbol : symbol - 1;
+		if (orderMinus1Bits == -1)
+			enc.write(orderMinus1Freqs, index);
+		else
+			enc.writeBits(index, orderMinus1Bits);
+	} else if (orderMinus1Bits == -1)
+		enc.write(orderMinus1Freqs, symbol);
+	else if (symbol == escapeSymbol)
+		enc.writeBit(ORDER_MINUS1_SYMBOL_PROBABILITY, 1);
+	else {
+		enc.writeBit(ORDER_MINUS1_SYMBOL_PROBABILITY, 0);
+		enc.writeBits(symbol < escapeSymbol ? symbol : symbol - 1, orderMinus1Bits);
+	}
+}
+
+
+uint32_t PpmModel::decodeSymbol(ArithmeticDecoder &dec, const vector<uint32_t> &history) const {
+	// Try to use highest order context that exists based on the history suffix. When the escape symbol
+	// is consumed at a context at any non-negative order, it means "escape to the next lower order
+	// with non-empty context". When the escape symbol is consumed at the order -1 context, it means "EOF".
+	for (int order = modelOrder == -1 ? -1 : static_cast<int>(history.size()); order >= 0; order--) {
+		Context *ctx = rootContext.get();
+		for (int i = 0; i < order; i++) {
+			if (ctx->subcontexts.empty())
+				throw std::logic_error("Assertion error");
+			ctx = ctx->subcontexts.at(history.at(i)).get();
+			if (ctx == nullptr)
+				goto outerEnd;
+		}
+		{
+			uint32_t symbol = dec.read(ctx->frequencies);
+			if (symbol != escapeSymbol)
+				return symbol;
+		}
+		// Else we read the context escape symbol, so continue decrementing the order
+		CODING_STATS_ESCAPE(order);
+		outerEnd:;
+	}
+	// Logic for order = -1
+	if (!hasEndSymbol) {
+		uint32_t index = orderMinus1Bits == -1 ? dec.read(orderMinus1Freqs) : dec.readBits(orderMinus1Bits);
+		return index < escapeSymbol ? index : index + 1;
+	}
+	if (orderMinus1Bits == -1)
+		return dec.read(orderMinus1Freqs);
+	if (dec.readBit(ORDER_MINUS1_SYMBOL_PROBABILITY) == 1)
+		return escapeSymbol;
+	uint32_t index = dec.readBits(orderMinus1Bits);
+	return index < escapeSymbol ? index : index + 1;
+}
+
+
+void PpmModel::pushHistory(vector<uint32_t> &history, uint32_t symbol) const {
+	if (modelOrder < 1)
+		return;
+	// Prepend current symbol, dropping oldest symbol if necessary
+	if (history.size() >= static_cast<unsigned int>(modelOrder))
+		history.erase(history.end() - 1);
+	history.insert(history.begin(), symbol);
+}
+
+
+void PpmModel::saveState(CheckpointWriter &out) const {
+	out.write(static_cast<uint64_t>(modelOrder + 1));
+	out.write(symbolLimit);
+	out.write(escapeSymbol);
+	out.write(hasEndSymbol ? 1 : 0);
+	out.write(static_cast<uint64_t>(orderMinus1Bits + 1));
+	if (rootContext.get() != nullptr)
+		saveContext(*rootContext, out);
+}
+
+
+void PpmModel::loadState(CheckpointReader &in) {
+	if (in.read() != static_cast<uint64_t>(modelOrder + 1) || in.read() != symbolLimit
+			|| in.read() != escapeSymbol || in.read() != (hasEndSymbol ? 1U : 0U)
+			|| in.read() != static_cast<uint64_t>(orderMinus1Bits + 1))
+		throw std::runtime_error("Different PPM model parameters in checkpoint");
+	if (rootContext.get() != nullptr)
+		rootContext = loadContext(in, 0);
+}
+
+
+void PpmModel::saveContext(const Context &ctx, CheckpointWriter &out) const {
+	// Nonzero frequencies, each preceded by the gap from the previous such symbol
+	uint32_t count = 0;
+	for (uint32_t i = 0; i < symbolLimit; i++) {
+		if (ctx.frequencies.get(i) > 0)
+			count++;
+	}
+	out.write(count);
+	uint32_t next = 0;
+	for (uint32_t i = 0; i < symbolLimit; i++) {
+		uint32_t freq = ctx.frequencies.get(i);
+		if (freq > 0) {
+			out.write(i - next);
+			out.write(freq);
+			next = i + 1;
+		}
+	}
+	
+	// Existing subcontexts in the same way, each followed by its contents
+	if (ctx.subcontexts.empty())
+		return;
+	count = 0;
+	for (const std::unique_ptr<Context> &subctx : ctx.subcontexts) {
+		if (subctx.get() != nullptr)
+			count++;
+	}
+	out.write(count);
+	next = 0;
+	for (uint32_t i = 0; i < symbolLimit; i++) {
+		const Context *subctx = ctx.subcontexts.at(i).get();
+		if (subctx != nullptr) {
+			out.write(i - next);
+			saveContext(*subctx, out);
+			next = i + 1;
+		}
+	}
+}
+
+
+std::unique_ptr<PpmModel::Context> PpmModel::loadContext(CheckpointReader &in, int depth) const {
+	bool hasSubctx = depth < modelOrder;
+	std::unique_ptr<Context> result(new Context(symbolLimit, hasSubctx));
+	uint64_t count = in.read(symbolLimit);
+	uint64_t next = 0;
+	for (uint64_t i = 0; i < count; i++) {
+		uint64_t sym = next + in.read(symbolLimit);
+		if (sym >= symbolLimit)
+			throw std::runtime_error("Invalid PPM context in checkpoint");
+		result->frequencies.set(static_cast<uint32_t>(sym), static_cast<uint32_t>(in.read(UINT32_MAX)));
+		next = sym + 1;
+	}
+	if (result->frequencies.get(escapeSymbol) == 0)
+		throw std::runtime_error("Invalid PPM context in checkpoint");
+	
+	if (hasSubctx) {
+		count = in.read(symbolLimit);
+		next = 0;
+		for (uint64_t i = 0; i < count; i++) {
+			uint64_t sym = next + in.read(symbolLimit);
+			if (sym >= symbolLimit)
+				throw std::runtime_error("Invalid PPM context in checkpoint");
+			result->subcontexts.at(sym) = loadContext(in, depth + 1);
+			next = sym + 1;
+		}
+	}
+	return result;
+}
+
+
+int PpmModel::getOrderMinus1Bits(uint32_t symLimit) {
+	uint32_t count = symLimit - 1;  // Excluding the escape symbol
+	if (count == 0 || (count & (count - 1)) != 0)
+		return -1;
+	int result = 0;
+	while ((UINT32_C(1) << result) != count)
+		result++;
+	return result;
+}
@@ -11,6 +11,8 @@
 #include <cstdint>
 #include <memory>
 #include <vector>
+#include "ArithmeticCoder.hpp"
+#include "Checkpoint.hpp"
 #include "FrequencyTable.hpp"
 
 
@@ -31,6 +33,17 @@ class PpmModel final {
 	
 	
 	
+	/*---- Constants ----*/
+	
+	// When the symbols other than the escape symbol number a power of two and the model was constructed with
+	// endAsDecision, the order -1 context codes whether the symbol is the escape symbol as a binary decision
+	// where any other symbol has this probability (in units of 2^-ArithmeticCoderBase::PROBABILITY_BITS),
+	// then any other symbol's index among them in equiprobable bits. That avoids a frequency table, and costs
+	// almost nothing beyond the index bits. Without an end symbol, the decision is omitted and only the index
+	// is coded, which gives the same bits as a uniform frequency table.
+	public: static constexpr std::uint32_t ORDER_MINUS1_SYMBOL_PROBABILITY = 4095;
+	
+	
 	/*---- Fields ----*/
 	
 	public: int modelOrder;
@@ -38,13 +51,26 @@ class PpmModel final {
 	private: std::uint32_t symbolLimit;
 	private: std::uint32_t escapeSymbol;
 	
+	// Whether coding the escape symbol at the order -1 context means EOF. If not, the length of
+	// the data is known from elsewhere (see LengthHeader.hpp), and the order -1 context codes only
+	// the other symbols, with no end decision.
+	private: bool hasEndSymbol;
+	
 	public: std::unique_ptr<Context> rootContext;
 	public: SimpleFrequencyTable orderMinus1Freqs;
 	
+	// The number of bits of an order -1 symbol index (see ORDER_MINUS1_SYMBOL_PROBABILITY), or -1 if
+	// orderMinus1Freqs is used instead because the symbols don't number a power of two, or because the
+	// end symbol is coded in the uniform table of the original PpmCompress format.
+	private: int orderMinus1Bits;
+	
 	
 	/*---- Constructor ----*/
 	
-	public: explicit PpmModel(int order, std::uint32_t symLimit, std::uint32_t escapeSym);
+	// Constructs a model of the given order (at least -1) over symbols below the given limit. If endAsDecision is
+	// false, the order -1 context codes the end symbol in a uniform table with all the others, which is the
+	// format of PpmCompress and the Java and Python versions. Block containers set it to true.
+	public: explicit PpmModel(int order, std::uint32_t symLimit, std::uint32_t escapeSym, bool hasEndSym=true, bool endAsDecision=false);
 	
 	
 	/*---- Methods ----*/
@@ -52,6 +78,45 @@ class PpmModel final {
 	public: void incrementContexts(const std::vector<std::uint32_t> &history, std::uint32_t symbol);
 	
 	
+	// Encodes the given symbol in the highest order context that exists based on the history suffix and in which
+	// the symbol has non-zero frequency, writing escape symbols for each higher order context that was skipped.
+	// Coding the escape symbol itself means "EOF", which can only be expressed at the order -1 context,
+	// and only if the model has an end symbol.
+	public: void encodeSymbol(ArithmeticEncoder &enc, const std::vector<std::uint32_t> &history, std::uint32_t symbol) const;
+	
+	
+	// Decodes and returns the next symbol, consuming any escape symbols along the way. This mirrors encodeSymbol().
+	public: std::uint32_t decodeSymbol(ArithmeticDecoder &dec, const std::vector<std::uint32_t> &history) const;
+	
+	
+	// Updates the given history (most recent symbol first) after the given symbol has been coded and counted,
+	// by prepending the symbol and dropping the oldest one so that it holds at most modelOrder symbols.
+	public: void pushHistory(std::vector<std::uint32_t> &history, std::uint32_t symbol) const;
+	
+	
+	// Appends the parameters and the whole context tree of this model to the given checkpoint. Each context
+	// is stored as its nonzero frequencies and the symbols of its existing subcontexts (as gaps between
+	// successive symbols) followed by those subcontexts, so the size is proportional to the model's content.
+	public: void saveState(CheckpointWriter &out) const;
+	
+	
+	// Replaces the context tree of this model with the one saved by saveState() from a model constructed
+	// with the same arguments. Throws an exception if the parameters differ or the checkpoint is malformed.
+	public: void loadState(CheckpointReader &in);
+	
+	
+	private: void saveContext(const Context &ctx, CheckpointWriter &out) const;
+	
+	
+	// Reads a context saved by saveContext() at the given depth in the tree (0 for the root).
+	private: std::unique_ptr<Context> loadContext(CheckpointReader &in, int depth) const;
+	
+	
 	private: static std::vector<std::uint32_t> makeEmpty(std::uint32_t len);
 	
+	
+	// Returns the number of bits of an order -1 symbol index for the given symbol limit
+	// (see ORDER_MINUS1_SYMBOL_PROBABILITY), or -1 if a frequency table must be used instead.
+	public: static int getOrderMinus1Bits(std::uint32_t symLimit);
+	
 };
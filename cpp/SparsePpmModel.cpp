@@ -0,0 +1,142 @@
+/* 
+ * Reference arithmetic coding
+ * Copyright (c) Project Nayuki
+ * 
+ * https://www.nayuki.io/page/reference-arithmetic-coding
+ * https://github.com/nayuki/Reference-arithmetic-coding
+ */
+
+#include <stdexcept>
+#include "CodingStats.hpp"
+#include "PpmModel.hpp"
+#include "SparsePpmModel.hpp"
+
+using std::uint32_t;
+using std::vector;
+
+
+SparsePpmModel::Context::Context(uint32_t symbols) :
+	frequencies(symbols) {}
+
+
+SparsePpmModel::SparsePpmModel(int order, uint32_t symLimit, uint32_t escapeSym, bool endAsDecision) :
+		modelOrder(order),
+		symbolLimit(symLimit),
+		escapeSymbol(escapeSym),
+		orderMinus1Freqs(symLimit),
+		orderMinus1Bits(endAsDecision ? PpmModel::getOrderMinus1Bits(symLimit) : -1) {
+	if (order < -1 || escapeSym >= symLimit)
+		throw std::domain_error("Illegal argument");
+	if (order >= 0) {
+		SparseFrequencyTable initial(symbolLimit);
+		initial.increment(escapeSymbol);
+		rootFrequencies.reset(new FenwickFrequencyTable(initial));
+		CODING_STATS_ADD(CONTEXTS_CREATED, 1);
+	}
+}
+
+
+void SparsePpmModel::incrementContexts(const vector<uint32_t> &history, uint32_t symbol) {
+	if (modelOrder == -1)
+		return;
+	if (history.size() > static_cast<unsigned int>(modelOrder) || symbol >= symbolLimit)
+		throw std::invalid_argument("Illegal argument");
+	
+	rootFrequencies->increment(symbol);
+	std::unordered_map<uint32_t, std::unique_ptr<Context> > *subctxs = &rootSubcontexts;
+	for (uint32_t sym : history) {
+		std::unique_ptr<Context> &subctx = (*subctxs)[sym];
+		if (subctx.get() == nullptr) {
+			subctx.reset(new Context(symbolLimit));
+			subctx->frequencies.increment(escapeSymbol);
+			CODING_STATS_ADD(CONTEXTS_CREATED, 1);
+		}
+		subctx->frequencies.increment(symbol);
+		subctxs = &subctx->subcontexts;
+	}
+}
+
+
+void SparsePpmModel::encodeSymbol(ArithmeticEncoder &enc, const vector<uint32_t> &history, uint32_t symbol) const {
+	CodingCostMeter *meter = enc.getCostMeter();
+	for (int order = modelOrder == -1 ? -1 : static_cast<int>(history.size()); order >= 0; order--) {
+		const FrequencyTable *freqs = rootFrequencies.get();
+		if (order >= 1) {
+			const Context *ctx = findContext(history, order);
+			if (ctx == nullptr)
+				continue;
+			freqs = &ctx->frequencies;
+		}
+		if (symbol != escapeSymbol && freqs->get(symbol) > 0) {
+			if (meter != nullptr)
+				meter->setCategory(order, CodingCostMeter::SYMBOL);
+			enc.write(*freqs, symbol);
+			return;
+		}
+		// Else write context escape symbol and continue decrementing the order
+		if (meter != nullptr)
+			meter->setCategory(order, CodingCostMeter::ESCAPE);
+		enc.write(*freqs, escapeSymbol);
+		CODING_STATS_ESCAPE(order);
+	}
+	// Logic for order = -1
+	if (meter != nullptr)
+		meter->setCategory(-1, symbol == escapeSymbol ? CodingCostMeter::END_OF_DATA : CodingCostMeter::SYMBOL);
+	if (orderMinus1Bits == -1)
+		enc.write(orderMinus1Freqs, symbol);
+	else if (symbol == escapeSymbol)
+		enc.writeBit(PpmModel::ORDER_MINUS1_SYMBOL_PROBABILITY, 1);
+	else {
+		enc.writeBit(PpmModel::ORDER_MINUS1_SYMBOL_PROBABILITY, 0);
+		enc.writeBits(symbol < escapeSymbol ? symbol : symbol - 1, orderMinus1Bits);
+	}
+}
+
+
+uint32_t SparsePpmModel::decodeSymbol(ArithmeticDecoder &dec, const vector<uint32_t> &history) const {
+	for (int order = modelOrder == -1 ? -1 : static_cast<int>(history.size()); order >= 0; order--) {
+		uint32_t symbol;
+		if (order >= 1) {
+			const Context *ctx = findContext(history, order);
+			if (ctx == nullptr)
+				continue;
+			symbol = dec.read(ctx->frequencies);
+		} else
+			symbol = dec.read(*rootFrequencies);
+		if (symbol != escapeSymbol)
+			return symbol;
+		// Else we read the context escape symbol, so continue decrementing the order
+		CODING_STATS_ESCAPE(order);
+	}
+	// Logic for order = -1
+	if (orderMinus1Bits == -1)
+		return dec.read(orderMinus1Freqs);
+	if (dec.readBit(PpmModel::ORDER_MINUS1_SYMBOL_PROBABILITY) == 1)
+		return escapeSymbol;
+	uint32_t index = dec.readBits(orderMinus1Bits);
+	return index < escapeSymbol ? index : index + 1;
+}
+
+
+void SparsePpmModel::pushHistory(vector<uint32_t> &history, uint32_t symbol) const {
+	if (modelOrder < 1)
+		return;
+	// Prepend current symbol, dropping oldest symbol if necessary
+	if (history.size() >= static_cast<unsigned int>(modelOrder))
+		history.erase(history.end() - 1);
+	history.insert(history.begin(), symbol);
+}
+
+
+const SparsePpmModel::Context *SparsePpmModel::findContext(const vector<uint32_t> &history, int order) const {
+	const std::unordered_map<uint32_t, std::unique_ptr<Context> > *subctxs = &rootSubcontexts;
+	const Context *result = nullptr;
+	for (int i = 0; i < order; i++) {
+		auto it = subctxs->find(history.at(i));
+		if (it == subctxs->end())
+			return nullptr;
+		result = it->second.get();
+		subctxs = &result->subcontexts;
+	}
+	return result;
+}
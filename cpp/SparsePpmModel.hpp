@@ -0,0 +1,93 @@
+/* 
+ * Reference arithmetic coding
+ * Copyright (c) Project Nayuki
+ * 
+ * https://www.nayuki.io/page/reference-arithmetic-coding
+ * https://github.com/nayuki/Reference-arithmetic-coding
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "ArithmeticCoder.hpp"
+#include "FrequencyTable.hpp"
+
+
+/* 
+ * A PPM model with the same contexts, escapes and coded format as PpmModel, for large alphabets such as
+ * 16-bit symbols. PpmModel gives every context a dense table and a dense array of subcontexts, each as
+ * wide as the alphabet, which doesn't fit in memory for more than a few thousand symbols. Here the order 0
+ * context uses a FenwickFrequencyTable, the higher order contexts use a SparseFrequencyTable each, and
+ * subcontexts are kept in a hash map by symbol, so memory grows with the distinct contexts and symbols
+ * seen. Since every context starts with only the escape symbol, the sparse tables stay small except in
+ * contexts that are followed by many different symbols, whose coding time then grows with that number.
+ */
+class SparsePpmModel final {
+	
+	/*---- Helper structure ----*/
+	
+	public: class Context final {
+		
+		public: SparseFrequencyTable frequencies;
+		
+		public: std::unordered_map<std::uint32_t, std::unique_ptr<Context> > subcontexts;
+		
+		
+		public: explicit Context(std::uint32_t symbols);
+		
+	};
+	
+	
+	
+	/*---- Fields ----*/
+	
+	public: int modelOrder;
+	
+	private: std::uint32_t symbolLimit;
+	private: std::uint32_t escapeSymbol;
+	
+	// The order 0 context's frequencies. Empty if modelOrder is -1.
+	private: std::unique_ptr<FenwickFrequencyTable> rootFrequencies;
+	
+	// The order 1 contexts, by the previous symbol.
+	private: std::unordered_map<std::uint32_t, std::unique_ptr<Context> > rootSubcontexts;
+	
+	// Used for order -1 if orderMinus1Bits is -1.
+	private: FlatFrequencyTable orderMinus1Freqs;
+	
+	// Same as in PpmModel, including being -1 unless endAsDecision was true.
+	private: int orderMinus1Bits;
+	
+	
+	/*---- Constructor ----*/
+	
+	// Constructs a model of the given order (at least -1) over symbols below the given limit, where the
+	// given escape symbol also means EOF at order -1. The order -1 context is coded like PpmModel's with
+	// the same endAsDecision, so both models produce identical data for the same arguments.
+	public: explicit SparsePpmModel(int order, std::uint32_t symLimit, std::uint32_t escapeSym, bool endAsDecision=false);
+	
+	
+	/*---- Methods ----*/
+	
+	public: void incrementContexts(const std::vector<std::uint32_t> &history, std::uint32_t symbol);
+	
+	
+	// Encodes the given symbol like PpmModel::encodeSymbol().
+	public: void encodeSymbol(ArithmeticEncoder &enc, const std::vector<std::uint32_t> &history, std::uint32_t symbol) const;
+	
+	
+	// Decodes and returns the next symbol like PpmModel::decodeSymbol().
+	public: std::uint32_t decodeSymbol(ArithmeticDecoder &dec, const std::vector<std::uint32_t> &history) const;
+	
+	
+	// Updates the given history like PpmModel::pushHistory().
+	public: void pushHistory(std::vector<std::uint32_t> &history, std::uint32_t symbol) const;
+	
+	
+	// Returns the context of the given order (at least 1) for the given history, or null if it doesn't exist yet.
+	private: const Context *findContext(const std::vector<std::uint32_t> &history, int order) const;
+	
+};
@@ -0,0 +1,209 @@
+/* 
+ * Round-trip tests for sync points made by ArithmeticEncoder::flush()
+ * 
+ * Usage: SyncFlushTest
+ * This codes random messages of symbols from a frequency table, binary decisions and equiprobable bits,
+ * flushing after each message, and checks that ArithmeticDecoder::flush() stops at the same byte offsets.
+ * The exit status is zero if every test passes.
+ * 
+ * Copyright (c) Project Nayuki
+ * 
+ * https://www.nayuki.io/page/reference-arithmetic-coding
+ * https://github.com/nayuki/Reference-arithmetic-coding
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "ArithmeticCoder.hpp"
+#include "BitIoStream.hpp"
+#include "FrequencyTable.hpp"
+
+using std::uint32_t;
+using std::vector;
+
+
+// A symbol and how it is coded: 0 = adaptive frequency table, 1 = binary decision, 2 = 8 equiprobable bits.
+struct Event {
+	int kind;
+	uint32_t value;
+};
+
+
+// The coded form of a sequence of messages, with a sync point after each message.
+struct FlushedStream {
+	std::string data;
+	vector<std::size_t> syncOffsets;  // Byte offset of the end of each message
+};
+
+
+static void testRoundTrip();
+static void testRoundTrip(const vector<vector<Event> > &messages);
+static void testDecodeUpToEachSyncPoint();
+static void testStartAtSyncPoint();
+static vector<vector<Event> > makeMessages(unsigned int seed, int numMessages, int minLength, int maxLength);
+static FlushedStream encode(const vector<vector<Event> > &messages, bool adaptive);
+static void decodeMessage(ArithmeticDecoder &dec, SimpleFrequencyTable &freqs, bool adaptive, const vector<Event> &msg);
+static void check(bool cond, const std::string &msg);
+
+
+static constexpr uint32_t ZERO_PROBABILITY = 3000;  // Out of 2^ArithmeticCoderBase::PROBABILITY_BITS
+
+
+int main() {
+	try {
+		testRoundTrip();
+		testDecodeUpToEachSyncPoint();
+		testStartAtSyncPoint();
+		std::cerr << "Test passed" << std::endl;
+		return EXIT_SUCCESS;
+	} catch (const std::exception &e) {
+		std::cerr << "Test failed: " << e.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+}
+
+
+// Flushes every N symbols for a few fixed N, then after messages of random length (including empty
+// ones, which make runs of flushes), and decodes the whole stream.
+static void testRoundTrip() {
+	const int FIXED_LENGTHS[] = {1, 5, 100};
+	for (int n : FIXED_LENGTHS) {
+		for (unsigned int seed = 0; seed < 5; seed++)
+			testRoundTrip(makeMessages(seed, 2000 / n, n, n));
+	}
+	for (unsigned int seed = 0; seed < 20; seed++)
+		testRoundTrip(makeMessages(seed, 100, 0, seed % 4 == 0 ? 3 : 60));
+}
+
+
+static void testRoundTrip(const vector<vector<Event> > &messages) {
+	FlushedStream stream = encode(messages, true);
+	std::istringstream in(stream.data);
+	BitInputStream bin(in);
+	ArithmeticDecoder dec(32, bin, true);
+	SimpleFrequencyTable freqs(FlatFrequencyTable(256));
+	for (std::size_t i = 0; i < messages.size(); i++) {
+		decodeMessage(dec, freqs, true, messages[i]);
+		dec.flush();
+		check(static_cast<std::size_t>(in.tellg()) == stream.syncOffsets[i], "Decoder is not at the sync point");
+	}
+	check(in.get() == EOF, "Data left after the last sync point");
+}
+
+
+// Gives the decoder only the bytes up to each sync point, which must be enough to decode every message
+// before it. The decoder throws if it reads past the end, so this also checks that it doesn't look ahead.
+static void testDecodeUpToEachSyncPoint() {
+	vector<vector<Event> > messages = makeMessages(100, 40, 0, 30);
+	FlushedStream stream = encode(messages, true);
+	for (std::size_t end = 0; end < messages.size(); end++) {
+		std::istringstream in(stream.data.substr(0, stream.syncOffsets[end]));
+		BitInputStream bin(in);
+		ArithmeticDecoder dec(32, bin, true);
+		SimpleFrequencyTable freqs(FlatFrequencyTable(256));
+		for (std::size_t i = 0; i <= end; i++) {
+			decodeMessage(dec, freqs, true, messages[i]);
+			dec.flush();
+		}
+	}
+}
+
+
+// With a static model, a new decoder can start at any sync point before the last one and decode the messages after it.
+static void testStartAtSyncPoint() {
+	vector<vector<Event> > messages = makeMessages(200, 50, 0, 40);
+	FlushedStream stream = encode(messages, false);
+	for (std::size_t start = 0; start + 1 < messages.size(); start++) {
+		std::istringstream in(stream.data.substr(stream.syncOffsets[start]));
+		BitInputStream bin(in);
+		ArithmeticDecoder dec(32, bin, true);
+		SimpleFrequencyTable freqs(FlatFrequencyTable(256));
+		for (std::size_t i = start + 1; i < messages.size(); i++) {
+			decodeMessage(dec, freqs, false, messages[i]);
+			dec.flush();
+		}
+		check(in.get() == EOF, "Data left after the last sync point");
+	}
+}
+
+
+// Returns random messages whose lengths are in the given range, with skewed byte values
+// so that the adaptive table and the binary decisions make the range shrink unevenly.
+static vector<vector<Event> > makeMessages(unsigned int seed, int numMessages, int minLength, int maxLength) {
+	std::mt19937 random(seed);
+	vector<vector<Event> > result;
+	for (int i = 0; i < numMessages; i++) {
+		vector<Event> msg;
+		int len = minLength + static_cast<int>(random() % static_cast<uint32_t>(maxLength - minLength + 1));
+		for (int j = 0; j < len; j++) {
+			Event ev;
+			ev.kind = static_cast<int>(random() % 3);
+			if (ev.kind == 1)
+				ev.value = random() % 4 == 0 ? 1 : 0;
+			else
+				ev.value = random() % 8 == 0 ? random() % 256 : random() % 4;
+			msg.push_back(ev);
+		}
+		result.push_back(msg);
+	}
+	return result;
+}
+
+
+// Encodes the given messages with a flush after each one, with the frequency table
+// being incremented after each symbol if adaptive is true.
+static FlushedStream encode(const vector<vector<Event> > &messages, bool adaptive) {
+	std::ostringstream out;
+	BitOutputStream bout(out);
+	ArithmeticEncoder enc(32, bout);
+	SimpleFrequencyTable freqs(FlatFrequencyTable(256));
+	FlushedStream result;
+	for (const vector<Event> &msg : messages) {
+		for (const Event &ev : msg) {
+			if (ev.kind == 0) {
+				enc.write(freqs, ev.value);
+				if (adaptive)
+					freqs.increment(ev.value);
+			} else if (ev.kind == 1)
+				enc.writeBit(ZERO_PROBABILITY, static_cast<int>(ev.value));
+			else
+				enc.writeBits(ev.value, 8);
+		}
+		enc.flush();
+		result.syncOffsets.push_back(static_cast<std::size_t>(bout.getByteCount()));
+	}
+	bout.finish();
+	result.data = out.str();
+	check(result.data.size() == result.syncOffsets.back(), "Flush did not end on a byte boundary");
+	return result;
+}
+
+
+// Decodes one message and checks that it matches the given events.
+static void decodeMessage(ArithmeticDecoder &dec, SimpleFrequencyTable &freqs, bool adaptive, const vector<Event> &msg) {
+	for (const Event &ev : msg) {
+		uint32_t value;
+		if (ev.kind == 0) {
+			value = dec.read(freqs);
+			if (adaptive)
+				freqs.increment(value);
+		} else if (ev.kind == 1)
+			value = static_cast<uint32_t>(dec.readBit(ZERO_PROBABILITY));
+		else
+			value = dec.readBits(8);
+		check(value == ev.value, "Decoded symbol mismatch");
+	}
+}
+
+
+static void check(bool cond, const std::string &msg) {
+	if (!cond)
+		throw std::logic_error(msg);
+}
@@ -0,0 +1,68 @@
+/* 
+ * Reference arithmetic coding
+ * Copyright (c) Project Nayuki
+ * 
+ * https://www.nayuki.io/page/reference-arithmetic-coding
+ * https://github.com/nayuki/Reference-arithmetic-coding
+ */
+
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include "ThreadPool.hpp"
+
+
+ThreadPool::ThreadPool(unsigned int numThreads) :
+		stopping(false) {
+	if (numThreads < 1)
+		throw std::domain_error("Number of threads must be positive");
+	for (unsigned int i = 0; i < numThreads; i++)
+		workers.emplace_back(&ThreadPool::runWorker, this);
+}
+
+
+ThreadPool::~ThreadPool() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	condition.notify_all();
+	for (std::thread &worker : workers)
+		worker.join();
+}
+
+
+std::future<void> ThreadPool::submit(std::function<void()> task) {
+	// A packaged_task is move-only but std::function requires copyable targets, hence the shared_ptr
+	std::shared_ptr<std::packaged_task<void()> > packaged =
+		std::make_shared<std::packaged_task<void()> >(std::move(task));
+	std::future<void> result = packaged->get_future();
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		tasks.push_back([packaged]() { (*packaged)(); });
+	}
+	condition.notify_one();
+	return result;
+}
+
+
+unsigned int ThreadPool::defaultThreadCount() {
+	unsigned int result = std::thread::hardware_concurrency();
+	return result > 0 ? result : 1;
+}
+
+
+void ThreadPool::runWorker() {
+	while (true) {
+		std::function<void()> task;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			condition.wait(lock, [this]() { return stopping || !tasks.empty(); });
+			if (tasks.empty())
+				return;  // Stopping and no more work
+			task = std::move(tasks.front());
+			tasks.pop_front();
+		}
+		task();
+	}
+}
@@ -0,0 +1,65 @@
+/* 
+ * Reference arithmetic coding
+ * Copyright (c) Project Nayuki
+ * 
+ * https://www.nayuki.io/page/reference-arithmetic-coding
+ * https://github.com/nayuki/Reference-arithmetic-coding
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+/* 
+ * A fixed set of worker threads that run submitted tasks in first-in first-out order.
+ * Destroying the pool waits for all queued tasks to finish.
+ */
+class ThreadPool final {
+	
+	/*---- Fields ----*/
+	
+	private: std::vector<std::thread> workers;
+	
+	// Tasks that have been submitted but not yet started.
+	private: std::deque<std::function<void()> > tasks;
+	
+	// Guards 'tasks' and 'stopping'.
+	private: std::mutex mutex;
+	
+	// Signaled when a task is queued or the pool is stopping.
+	private: std::condition_variable condition;
+	
+	// Set when the pool is being destroyed, after which the workers exit once the queue is empty.
+	private: bool stopping;
+	
+	
+	/*---- Constructor ----*/
+	
+	// Starts the given number of worker threads, which must be positive.
+	public: explicit ThreadPool(unsigned int numThreads);
+	
+	
+	public: ~ThreadPool();
+	
+	
+	/*---- Methods ----*/
+	
+	// Queues the given task to run on some worker thread. The returned future becomes
+	// ready when the task finishes, and rethrows any exception that the task threw.
+	public: std::future<void> submit(std::function<void()> task);
+	
+	
+	// Returns the number of threads to use when the user doesn't specify one, which is at least 1.
+	public: static unsigned int defaultThreadCount();
+	
+	
+	private: void runWorker();
+	
+};
@@ -0,0 +1,72 @@
+/* 
+ * Reference arithmetic coding
+ * Copyright (c) Project Nayuki
+ * 
+ * https://www.nayuki.io/page/reference-arithmetic-coding
+ * https://github.com/nayuki/Reference-arithmetic-coding
+ */
+
+#include <limits>
+#include <stdexcept>
+#include "WideSymbolIo.hpp"
+
+using std::uint32_t;
+
+
+static void putByte(std::ostream &out, int b);
+
+
+long WideSymbolIo::readSymbol(std::istream &in, int &trailingByte) {
+	trailingByte = -1;
+	int lowByte = in.get();
+	if (lowByte == std::char_traits<char>::eof())
+		return -1;
+	int highByte = in.get();
+	if (highByte == std::char_traits<char>::eof()) {
+		trailingByte = lowByte;
+		return -1;
+	}
+	if (lowByte < 0 || lowByte > 255 || highByte < 0 || highByte > 255)
+		throw std::logic_error("Assertion error");
+	return static_cast<long>(highByte) << 8 | lowByte;
+}
+
+
+void WideSymbolIo::writeSymbol(std::ostream &out, uint32_t symbol) {
+	if (symbol >= NUM_SYMBOLS)
+		throw std::domain_error("Symbol out of range");
+	putByte(out, static_cast<int>(symbol & 0xFF));
+	putByte(out, static_cast<int>(symbol >> 8));
+}
+
+
+void WideSymbolIo::writeTrailer(std::ostream &out, int trailingByte) {
+	if (trailingByte < -1 || trailingByte > 255)
+		throw std::domain_error("Byte out of range");
+	if (trailingByte != -1)
+		putByte(out, trailingByte);
+}
+
+
+void WideSymbolIo::encodeTrailer(ArithmeticEncoder &enc, int trailingByte) {
+	if (trailingByte < -1 || trailingByte > 255)
+		throw std::domain_error("Byte out of range");
+	enc.writeBits(trailingByte != -1 ? 1 : 0, 1);
+	if (trailingByte != -1)
+		enc.writeBits(static_cast<uint32_t>(trailingByte), 8);
+}
+
+
+int WideSymbolIo::decodeTrailer(ArithmeticDecoder &dec) {
+	if (dec.readBits(1) == 0)
+		return -1;
+	return static_cast<int>(dec.readBits(8));
+}
+
+
+// Writes the given byte value (0 to 255) as a char, which may be signed.
+static void putByte(std::ostream &out, int b) {
+	if (std::numeric_limits<char>::is_signed)
+		b -= (b >> 7) << 8;
+	out.put(static_cast<char>(b));
+}
@@ -0,0 +1,54 @@
+/* 
+ * Reference arithmetic coding
+ * Copyright (c) Project Nayuki
+ * 
+ * https://www.nayuki.io/page/reference-arithmetic-coding
+ * https://github.com/nayuki/Reference-arithmetic-coding
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include "ArithmeticCoder.hpp"
+
+
+/* 
+ * Reads and writes the 16-bit symbols that the applications code with --symbol-bits=16, where the
+ * input is a sequence of little-endian 16-bit values (such as UTF-16LE text or audio samples). The
+ * alphabet is then 65536 symbols plus the EOF symbol. An input of odd length has one trailing byte
+ * that doesn't form a symbol; it is coded after the EOF symbol as a flag bit and then 8 bits, which
+ * are equiprobable bits (see ArithmeticEncoder::writeBits()), so that any file can be compressed.
+ */
+class WideSymbolIo final {
+	
+	/*---- Constants ----*/
+	
+	// The number of data symbols, which is also the EOF symbol.
+	public: static constexpr std::uint32_t NUM_SYMBOLS = UINT32_C(1) << 16;
+	
+	
+	/*---- Methods ----*/
+	
+	// Reads and returns the next symbol, or returns -1 at the end of the input, in which case the
+	// trailing byte (0 to 255) is stored in the given variable if there is one, otherwise -1.
+	public: static long readSymbol(std::istream &in, int &trailingByte);
+	
+	
+	// Writes the given symbol, which must be less than NUM_SYMBOLS.
+	public: static void writeSymbol(std::ostream &out, std::uint32_t symbol);
+	
+	
+	// Writes the given trailing byte, or nothing if it is -1.
+	public: static void writeTrailer(std::ostream &out, int trailingByte);
+	
+	
+	// Encodes the given trailing byte, or -1 if there is none. Call this after encoding the EOF symbol.
+	public: static void encodeTrailer(ArithmeticEncoder &enc, int trailingByte);
+	
+	
+	// Decodes and returns the trailing byte, or -1 if there is none. Call this after decoding the EOF symbol.
+	public: static int decodeTrailer(ArithmeticDecoder &dec);
+	
+};